@@ -195,6 +195,25 @@ bool ValidateProp(const sysprop::Properties& props,
       break;
   }
 
+  if (prop.cache_policy() == sysprop::Boot &&
+      prop.access() == sysprop::ReadWrite) {
+    if (err) {
+      *err = "Prop \"" + prop_name +
+             "\" has cache_policy: Boot, but is ReadWrite";
+    }
+    return false;
+  }
+
+  // Only "ro." properties are immutable once set, even if Readonly.
+  if (prop.cache_policy() == sysprop::Boot &&
+      !android::base::StartsWith(prop_name, "ro.")) {
+    if (err) {
+      *err = "Prop \"" + prop_name +
+             "\" has cache_policy: Boot, but doesn't have prefix \"ro.\"";
+    }
+    return false;
+  }
+
   if (prop.integer_as_bool() && !(prop.type() == sysprop::Boolean ||
                                   prop.type() == sysprop::BooleanList)) {
     if (err) {
@@ -275,6 +294,13 @@ bool IsDirectory(const std::string& path) {
   return S_ISDIR(st.st_mode);
 }
 
+bool HasCachePolicy(const sysprop::Properties& props,
+                    sysprop::CachePolicy policy) {
+  return std::any_of(
+      props.prop().begin(), props.prop().end(),
+      [policy](const auto& prop) { return prop.cache_policy() == policy; });
+}
+
 bool IsListProp(const sysprop::Property& prop) {
   switch (prop.type()) {
     case sysprop::BooleanList:
@@ -22,12 +22,16 @@
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <algorithm>
 #include <cerrno>
+#include <map>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include "CodeWriter.h"
 #include "Common.h"
+#include "RuntimeFragments.h"
 #include "sysprop.pb.h"
 
 namespace {
@@ -43,146 +47,426 @@ constexpr const char* kCppHeaderIncludes =
 )";
 
 constexpr const char* kCppSourceIncludes =
-    R"(#include <cctype>
+    R"(#include <algorithm>
+#include <atomic>
 #include <cerrno>
-#include <cstdio>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <utility>
 
-#include <strings.h>
 #include <sys/system_properties.h>
 
-#include <android-base/parseint.h>
 #include <log/log.h>
 
 )";
 
-constexpr const char* kCppParsersAndFormatters =
-    R"(template <typename T> constexpr bool is_vector = false;
+// Used instead of kCppSourceIncludes by sources which link against
+// libsysprop_runtime.
+constexpr const char* kCppRuntimeSourceIncludes =
+    R"(#include <cstring>
 
-template <typename T> constexpr bool is_vector<std::vector<T>> = true;
+#include <log/log.h>
+#include <sysprop/Runtime.h>
 
-template <> [[maybe_unused]] std::optional<bool> DoParse(const char* str) {
-    static constexpr const char* kYes[] = {"1", "true"};
-    static constexpr const char* kNo[] = {"0", "false"};
+)";
 
-    for (const char* yes : kYes) {
-        if (strcasecmp(yes, str) == 0) return std::make_optional(true);
+// Defines InlineList and InlineStringList in the namespace of the module.
+constexpr const char* kCppInlineList =
+    R"(// Holds the elements of a list inline. Values of non-"ro." properties are
+// shorter than PROP_VALUE_MAX, so they have at most that many elements, and
+// reading one into an InlineList never allocates.
+template <typename T, std::size_t N = PROP_VALUE_MAX>
+class InlineList {
+  public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    using value_type = T;
+    using const_iterator = const T*;
+
+    InlineList() = default;
+    // Only the elements in use are copied.
+    InlineList(const InlineList& other) { *this = other; }
+    InlineList& operator=(const InlineList& other) {
+        if (this == &other) return *this;
+        size_ = other.size_;
+        std::memcpy(storage_, other.storage_, size_ * sizeof(T));
+        return *this;
     }
 
-    for (const char* no : kNo) {
-        if (strcasecmp(no, str) == 0) return std::make_optional(false);
+    static constexpr std::size_t capacity() { return N; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T* data() const { return std::launder(reinterpret_cast<const T*>(storage_)); }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+    const T& operator[](std::size_t i) const { return data()[i]; }
+
+    // Used by the parser. Elements past the capacity are dropped.
+    void reserve(std::size_t) {}
+    void emplace_back(const T& element) {
+        if (size_ < N) new (storage_ + size_++ * sizeof(T)) T(element);
     }
 
-    return std::nullopt;
+  protected:
+    T* mutable_data() { return std::launder(reinterpret_cast<T*>(storage_)); }
+
+  private:
+    std::size_t size_ = 0;
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+};
+
+// Also holds the characters of its elements, so that the string_views stay
+// valid for as long as the list does.
+class InlineStringList : public InlineList<std::optional<std::string_view>> {
+  public:
+    InlineStringList() = default;
+    InlineStringList(const InlineStringList& other) : InlineList() { *this = other; }
+    InlineStringList& operator=(const InlineStringList& other) {
+        if (this == &other) return *this;
+        InlineList::operator=(other);
+        chars_size_ = other.chars_size_;
+        std::memcpy(chars_, other.chars_, chars_size_);
+        for (std::size_t i = 0; i < size(); ++i) {
+            auto& element = mutable_data()[i];
+            if (element) {
+                element = std::string_view(chars_ + (element->data() - other.chars_),
+                                           element->size());
+            }
+        }
+        return *this;
+    }
+
+    void emplace_back(std::optional<std::string_view> element) {
+        if (element) {
+            if (element->size() > sizeof(chars_) - chars_size_) return;
+            std::memcpy(chars_ + chars_size_, element->data(), element->size());
+            element = std::string_view(chars_ + chars_size_, element->size());
+            chars_size_ += element->size();
+        }
+        InlineList::emplace_back(element);
+    }
+
+  private:
+    char chars_[PROP_VALUE_MAX];
+    std::size_t chars_size_ = 0;
+};
+)";
+
+// Defines EnumSet and PackedBoolList in the namespace of the module.
+constexpr const char* kCppCompactTypes =
+    R"(// Set of the values of an enum with N enumerators, one bit each, for reading
+// an EnumList whose order and repeated names don't matter. Names which aren't
+// enumerators are skipped.
+template <typename E, std::size_t N>
+class EnumSet {
+  public:
+    using value_type = std::optional<E>;
+
+    bool contains(E value) const { return bits_[static_cast<std::size_t>(value)]; }
+    std::size_t size() const { return bits_.count(); }
+    bool empty() const { return bits_.none(); }
+
+    bool operator==(const EnumSet& other) const { return bits_ == other.bits_; }
+    bool operator!=(const EnumSet& other) const { return bits_ != other.bits_; }
+
+    void insert(E value) { bits_[static_cast<std::size_t>(value)] = true; }
+
+    // Used by the parser.
+    void reserve(std::size_t) {}
+    void emplace_back(const std::optional<E>& value) {
+        if (value) insert(*value);
+    }
+
+  private:
+    std::bitset<N> bits_;
+};
+
+// A BooleanList of a non-"ro." property, with two bits per element: whether it
+// has a value, and the value.
+class PackedBoolList {
+  public:
+    using value_type = std::optional<bool>;
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    std::optional<bool> operator[](std::size_t i) const {
+        if (!present_[i]) return std::nullopt;
+        return values_[i];
+    }
+
+    // Used by the parser. Elements past PROP_VALUE_MAX are dropped.
+    void reserve(std::size_t) {}
+    void emplace_back(const std::optional<bool>& value) {
+        if (size_ == PROP_VALUE_MAX) return;
+        if (value) {
+            present_[size_] = true;
+            values_[size_] = *value;
+        }
+        ++size_;
+    }
+
+  private:
+    std::bitset<PROP_VALUE_MAX> present_;
+    std::bitset<PROP_VALUE_MAX> values_;
+    std::size_t size_ = 0;
+};
+)";
+
+// Shared by the C accessors of every module, hence the guard.
+constexpr const char* kCStatus =
+    R"(#ifndef SYSPROP_STATUS_DEFINED
+#define SYSPROP_STATUS_DEFINED
+typedef enum {
+    SYSPROP_OK = 0,
+    // The property isn't set, or its value is empty.
+    SYSPROP_MISSING,
+    // The value doesn't parse as the type of the property.
+    SYSPROP_INVALID,
+    // The buffers of the caller are too small. The sizes they would need are
+    // stored in place of their capacities.
+    SYSPROP_TOO_SMALL,
+    // The formatted value is too long for the property.
+    SYSPROP_TOO_LONG,
+    // The property service didn't take the value.
+    SYSPROP_FAILED,
+} sysprop_status_t;
+#endif
+
+)";
+
+// Used by the extern "C" accessors to parse and format values the same way as
+// the C++ ones, straight from and into the buffers of the caller.
+constexpr const char* kCppCAccessors =
+    R"(// Calls |read| with the current value of the property, and returns the status it
+// returns.
+template <typename Read>
+sysprop_status_t ReadCValue(PropHandle& handle, Read read) {
+    auto pi = handle.Find();
+    if (pi == nullptr) return SYSPROP_MISSING;
+    std::pair<Read*, sysprop_status_t> args(&read, SYSPROP_OK);
+    __system_property_read_callback(pi, [](void* cookie, const char*, const char* value, std::uint32_t) {
+        auto args = static_cast<std::pair<Read*, sysprop_status_t>*>(cookie);
+        args->second = (*args->first)(std::string_view(value));
+    }, &args);
+    return args.second;
 }
 
-template <> [[maybe_unused]] std::optional<std::int32_t> DoParse(const char* str) {
-    std::int32_t ret;
-    return android::base::ParseInt(str, &ret) ? std::make_optional(ret) : std::nullopt;
+template <typename C, typename T>
+std::optional<C> ToCValue(const std::optional<T>& value) {
+    return value ? std::make_optional(static_cast<C>(*value)) : std::nullopt;
 }
 
-template <> [[maybe_unused]] std::optional<std::int64_t> DoParse(const char* str) {
-    std::int64_t ret;
-    return android::base::ParseInt(str, &ret) ? std::make_optional(ret) : std::nullopt;
+template <typename T, typename C>
+std::optional<T> FromCValue(const C* value) {
+    return value ? std::make_optional(static_cast<T>(*value)) : std::nullopt;
 }
 
-template <> [[maybe_unused]] std::optional<double> DoParse(const char* str) {
-    int old_errno = errno;
-    errno = 0;
-    char* end;
-    double ret = std::strtod(str, &end);
-    if (errno != 0) {
-        return std::nullopt;
-    }
-    if (str == end || *end != '\0') {
-        errno = EINVAL;
-        return std::nullopt;
-    }
-    errno = old_errno;
-    return std::make_optional(ret);
+[[maybe_unused]] sysprop_status_t ToCStatus(bool ok) {
+    if (ok) return SYSPROP_OK;
+    return errno == E2BIG ? SYSPROP_TOO_LONG : SYSPROP_FAILED;
 }
 
-template <> [[maybe_unused]] std::optional<std::string> DoParse(const char* str) {
-    return *str == '\0' ? std::nullopt : std::make_optional(str);
+template <typename C, typename Parse>
+sysprop_status_t GetCValue(PropHandle& handle, Parse parse, C* value) {
+    return ReadCValue(handle, [&](std::string_view str) {
+        if (str.empty()) return SYSPROP_MISSING;
+        std::optional<C> parsed = ToCValue<C>(parse(str));
+        if (!parsed) return SYSPROP_INVALID;
+        *value = *parsed;
+        return SYSPROP_OK;
+    });
 }
 
-template <typename Vec> [[maybe_unused]] Vec DoParseList(const char* str) {
-    Vec ret;
-    const char* p = str;
-    for (;;) {
-        const char* found = p;
-        while (*found != '\0' && *found != ',') {
-            ++found;
+// Takes the elements from ParseListInto, in place of a vector, and stores them
+// in the arrays of the caller. Those which don't fit are only counted.
+template <typename C>
+class CList {
+  public:
+    CList(C* values, bool* present, std::size_t capacity)
+        : values_(values), present_(present), capacity_(capacity) {}
+
+    void reserve(std::size_t) {}
+
+    template <typename T>
+    void emplace_back(const std::optional<T>& element) {
+        if (size_ < capacity_) {
+            std::optional<C> value = ToCValue<C>(element);
+            values_[size_] = value.value_or(C());
+            if (present_ != nullptr) present_[size_] = value.has_value();
         }
-        std::string value(p, found);
-        ret.emplace_back(DoParse<typename Vec::value_type>(value.c_str()));
-        if (*found == '\0') break;
-        p = found + 1;
+        ++size_;
     }
-    return ret;
+
+    std::size_t size() const { return size_; }
+
+  private:
+    C* values_;
+    bool* present_;
+    std::size_t capacity_;
+    std::size_t size_ = 0;
+};
+
+template <typename C, typename Parse>
+sysprop_status_t GetCList(PropHandle& handle, Parse parse, C* values, bool* present,
+                          std::size_t* size) {
+    std::size_t capacity = *size;
+    *size = 0;
+    return ReadCValue(handle, [&](std::string_view str) {
+        CList<C> list(values, present, capacity);
+        ParseListInto(str, parse, &list);
+        *size = list.size();
+        return list.size() <= capacity ? SYSPROP_OK : SYSPROP_TOO_SMALL;
+    });
 }
 
-template <typename T> inline T TryParse(const char* str) {
-    if constexpr(is_vector<T>) {
-        return DoParseList<T>(str);
-    } else {
-        return DoParse<T>(str);
-    }
+[[maybe_unused]] sysprop_status_t GetCString(PropHandle& handle, char* buf, std::size_t* size) {
+    std::size_t capacity = *size;
+    *size = 0;
+    return ReadCValue(handle, [&](std::string_view str) {
+        if (str.empty()) return SYSPROP_MISSING;
+        *size = str.size() + 1;
+        if (*size > capacity) return SYSPROP_TOO_SMALL;
+        std::memcpy(buf, str.data(), str.size());
+        buf[str.size()] = '\0';
+        return SYSPROP_OK;
+    });
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<std::int32_t>& value) {
-    return value ? std::to_string(*value) : "";
+// Same as CList, for StringList properties. Elements are copied to |buf| one
+// after the other, each NUL-terminated, and |items| point at them, or are
+// nullptr for empty elements.
+class CStringList {
+  public:
+    CStringList(char* buf, std::size_t buf_size, const char** items, std::size_t capacity)
+        : buf_(buf), buf_size_(buf_size), items_(items), capacity_(capacity) {}
+
+    void reserve(std::size_t) {}
+
+    void emplace_back(std::string_view element) {
+        const char* item = nullptr;
+        if (!element.empty()) {
+            std::size_t offset = chars_;
+            chars_ += element.size() + 1;
+            if (chars_ <= buf_size_) {
+                std::memcpy(buf_ + offset, element.data(), element.size());
+                buf_[offset + element.size()] = '\0';
+                item = buf_ + offset;
+            }
+        }
+        if (size_ < capacity_) items_[size_] = item;
+        ++size_;
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t chars() const { return chars_; }
+
+  private:
+    char* buf_;
+    std::size_t buf_size_;
+    const char** items_;
+    std::size_t capacity_;
+    std::size_t size_ = 0;
+    std::size_t chars_ = 0;
+};
+
+[[maybe_unused]] sysprop_status_t GetCStringList(PropHandle& handle, char* buf,
+                                                 std::size_t* buf_size, const char** items,
+                                                 std::size_t* size) {
+    std::size_t buf_capacity = *buf_size;
+    std::size_t capacity = *size;
+    *buf_size = 0;
+    *size = 0;
+    return ReadCValue(handle, [&](std::string_view str) {
+        CStringList list(buf, buf_capacity, items, capacity);
+        ParseListInto(str, [](std::string_view element) { return element; }, &list);
+        *buf_size = list.chars();
+        *size = list.size();
+        bool fits = list.chars() <= buf_capacity && list.size() <= capacity;
+        return fits ? SYSPROP_OK : SYSPROP_TOO_SMALL;
+    });
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<std::int64_t>& value) {
-    return value ? std::to_string(*value) : "";
+template <typename Format>
+sysprop_status_t SetCValue(const char* name, bool integer_as_bool, Format format) {
+    ValueBuffer buf(name, integer_as_bool);
+    format(buf);
+    if (buf.overflowed()) return SYSPROP_TOO_LONG;
+    return __system_property_set(name, buf.c_str()) == 0 ? SYSPROP_OK : SYSPROP_FAILED;
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<double>& value) {
-    if (!value) return "";
-    char buf[1024];
-    std::sprintf(buf, "%.*g", std::numeric_limits<double>::max_digits10, *value);
-    return buf;
+template <typename T, typename C>
+sysprop_status_t SetCList(const char* name, bool integer_as_bool, const C* values,
+                          const bool* present, std::size_t size) {
+    return SetCValue(name, integer_as_bool, [&](ValueBuffer& buf) {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i > 0) buf.Append(",");
+            if (present == nullptr || present[i]) {
+                FormatValue(buf, std::make_optional(static_cast<T>(values[i])));
+            }
+        }
+    });
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<bool>& value) {
-    return value ? (*value ? "true" : "false") : "";
+[[maybe_unused]] sysprop_status_t SetCStringList(const char* name, const char* const* items,
+                                                 std::size_t size) {
+    return SetCValue(name, false, [&](ValueBuffer& buf) {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i > 0) buf.Append(",");
+            if (items[i] != nullptr) buf.Append(items[i]);
+        }
+    });
 }
 
-template <typename T>
-[[maybe_unused]] std::string FormatValue(const std::vector<T>& value) {
-    if (value.empty()) return "";
+)";
 
-    std::string ret;
-    bool first = true;
+// Table-driven sources format enums in the runtime, so their C setters go
+// through WriteEnumList.
+constexpr const char* kCppCTableAccessors =
+    R"(template <typename C>
+bool WriteCEnumList(const PropDescriptor& prop, const C* values, const bool* present,
+                    std::size_t size) {
+    using List = std::pair<const C*, const bool*>;
+    List list(values, present);
+    return WriteEnumList(prop, size, [](const void* list, std::size_t i) -> std::optional<std::size_t> {
+        auto [values, present] = *static_cast<const List*>(list);
+        if (present != nullptr && !present[i]) return std::nullopt;
+        return static_cast<std::size_t>(values[i]);
+    }, &list);
+}
 
-    for (auto&& element : value) {
-        if (!first) ret += ",";
-        else first = false;
-        if constexpr(std::is_same_v<T, std::optional<std::string>>) {
-            if (element) ret += *element;
-        } else {
-            ret += FormatValue(element);
-        }
-    }
+)";
 
-    return ret;
+// Defines Prop, the type of the handles emitted with --typed-handles, in the
+// namespace of the module.
+constexpr const char* kCppTypedProp =
+    R"(// A property as a constant, for code written once over properties. The name,
+// type and access of the property are part of the type of its handle, so Get()
+// and Set() compile to direct calls of its accessors.
+template <typename T, typename Tag>
+struct Prop {
+    using value_type = T;
+    static constexpr const char* name = Tag::kName;
+    static constexpr bool writable = Tag::kWritable;
+};
+
+template <typename T, typename Tag>
+decltype(auto) Get(Prop<T, Tag>) {
+    return Tag::Get();
 }
 
-template <typename T>
-T GetProp(const char* key) {
-    T ret;
-    auto pi = __system_property_find(key);
-    if (pi != nullptr) {
-        __system_property_read_callback(pi, [](void* cookie, const char*, const char* value, std::uint32_t) {
-            *static_cast<T*>(cookie) = TryParse<T>(value);
-        }, &ret);
-    }
-    return ret;
+template <typename T, typename Tag>
+bool Set(Prop<T, Tag>, const T& value) {
+    static_assert(Tag::kWritable, "The property has no setter in this header");
+    return Tag::Set(value);
 }
-
 )";
 
 const std::regex kRegexDot{"\\."};
@@ -190,12 +474,47 @@ const std::regex kRegexUnderscore{"_"};
 
 std::string GetCppEnumName(const sysprop::Property& prop);
 std::string GetCppPropTypeName(const sysprop::Property& prop);
+std::string GetCppGetterTypeName(const sysprop::Property& prop);
+std::string GetCppInlineListTypeName(const sysprop::Property& prop);
+std::string GetCppPmrTypeName(const sysprop::Property& prop);
+std::string GetCppCompactTypeName(const sysprop::Property& prop);
+std::string GetCppCompactGetterName(const sysprop::Property& prop);
+bool WritesThrough(const sysprop::Property& prop, const CppGenOptions& options);
 std::string GetCppNamespace(const sysprop::Properties& props);
+std::string GetScopeNamespace(sysprop::Scope scope);
+void WriteSnapshotStruct(CodeWriter& writer, const sysprop::Properties& props,
+                         sysprop::Scope scope);
+void WriteWatcherClass(CodeWriter& writer, const sysprop::Properties& props,
+                       sysprop::Scope scope);
+void WriteTypedHandles(CodeWriter& writer, const sysprop::Properties& props,
+                       sysprop::Scope scope);
+std::string GetCHeaderName(const std::string& header_name);
+std::string GetCPrefix(const sysprop::Properties& props);
+std::string GetCTypeName(const sysprop::Properties& props,
+                         const sysprop::Property& prop);
+std::string GetCAccessorParams(const sysprop::Properties& props,
+                               const sysprop::Property& prop, bool setter);
+void WriteCAccessors(CodeWriter& writer, const sysprop::Properties& props,
+                     const CppGenOptions& options);
+void WriteSnapshotFunctions(CodeWriter& writer,
+                            const sysprop::Properties& props,
+                            sysprop::Scope scope);
+void WriteWatcherFunctions(CodeWriter& writer,
+                           const sysprop::Properties& props,
+                           sysprop::Scope scope);
+void WriteRuntimeFragment(CodeWriter& writer, const char* fragment);
+void WriteEnumParser(CodeWriter& writer, const sysprop::Property& prop,
+                     const std::string& enum_name);
+void WritePropDescriptors(CodeWriter& writer,
+                          const sysprop::Properties& props,
+                          const CppGenOptions& options);
 
 std::string GenerateHeader(const sysprop::Properties& props,
-                           sysprop::Scope scope);
+                           sysprop::Scope scope, const CppGenOptions& options);
 std::string GenerateSource(const sysprop::Properties& props,
-                           const std::string& include_name);
+                           const std::string& include_name,
+                           const CppGenOptions& options);
+std::string GenerateCHeader(const sysprop::Properties& props);
 
 std::string GetCppEnumName(const sysprop::Property& prop) {
   return ApiNameToIdentifier(prop.api_name()) + "_values";
@@ -232,22 +551,651 @@ std::string GetCppPropTypeName(const sysprop::Property& prop) {
   }
 }
 
+// Boot values are parsed once, so they are handed out by reference.
+std::string GetCppGetterTypeName(const sysprop::Property& prop) {
+  std::string type = GetCppPropTypeName(prop);
+  if (prop.cache_policy() == sysprop::Boot) return "const " + type + "&";
+  return type;
+}
+
+// Only lists of non-"ro." properties are bounded by PROP_VALUE_MAX, so other
+// properties have no <prop>_Inline().
+std::string GetCppInlineListTypeName(const sysprop::Property& prop) {
+  if (android::base::StartsWith(prop.prop_name(), "ro.")) return "";
+  switch (prop.type()) {
+    case sysprop::BooleanList:
+      return "InlineList<std::optional<bool>>";
+    case sysprop::IntegerList:
+      return "InlineList<std::optional<std::int32_t>>";
+    case sysprop::LongList:
+      return "InlineList<std::optional<std::int64_t>>";
+    case sysprop::DoubleList:
+      return "InlineList<std::optional<double>>";
+    case sysprop::StringList:
+      return "InlineStringList";
+    case sysprop::EnumList:
+      return "InlineList<std::optional<" + GetCppEnumName(prop) + ">>";
+    default:
+      return "";
+  }
+}
+
+// Types which allocate have getters taking a memory_resource, other types
+// don't.
+std::string GetCppPmrTypeName(const sysprop::Property& prop) {
+  switch (prop.type()) {
+    case sysprop::String:
+      return "std::optional<std::pmr::string>";
+    case sysprop::BooleanList:
+      return "std::pmr::vector<std::optional<bool>>";
+    case sysprop::IntegerList:
+      return "std::pmr::vector<std::optional<std::int32_t>>";
+    case sysprop::LongList:
+      return "std::pmr::vector<std::optional<std::int64_t>>";
+    case sysprop::DoubleList:
+      return "std::pmr::vector<std::optional<double>>";
+    case sysprop::StringList:
+      return "std::pmr::vector<std::optional<std::pmr::string>>";
+    case sysprop::EnumList:
+      return "std::pmr::vector<std::optional<" + GetCppEnumName(prop) + ">>";
+    default:
+      return "";
+  }
+}
+
+// Type returned by the getter which compact mode adds to EnumList and
+// non-"ro." BooleanList properties, or an empty string for other properties.
+std::string GetCppCompactTypeName(const sysprop::Property& prop) {
+  if (prop.type() == sysprop::EnumList) {
+    return android::base::StringPrintf(
+        "EnumSet<%s, %zu>", GetCppEnumName(prop).c_str(),
+        android::base::Split(prop.enum_values(), "|").size());
+  }
+  if (prop.type() == sysprop::BooleanList &&
+      !android::base::StartsWith(prop.prop_name(), "ro.")) {
+    return "PackedBoolList";
+  }
+  return "";
+}
+
+std::string GetCppCompactGetterName(const sysprop::Property& prop) {
+  std::string prop_id = ApiNameToIdentifier(prop.api_name());
+  return prop_id + (prop.type() == sysprop::EnumList ? "_Set" : "_Packed");
+}
+
+// Whether the setter of |prop| stores the value it wrote in the cache of the
+// getter. Table-driven sources leave formatting enums to the runtime, so only
+// the runtime can set them.
+bool WritesThrough(const sysprop::Property& prop,
+                   const CppGenOptions& options) {
+  if (!options.elide_writes || prop.access() == sysprop::Readonly) {
+    return false;
+  }
+  if (prop.cache_policy() == sysprop::Boot) return false;
+  if (!options.cache_values && prop.cache_policy() != sysprop::Serial) {
+    return false;
+  }
+  return !options.table ||
+         (prop.type() != sysprop::Enum && prop.type() != sysprop::EnumList);
+}
+
 std::string GetCppNamespace(const sysprop::Properties& props) {
   return std::regex_replace(props.module(), kRegexDot, "::");
 }
 
-std::string GenerateHeader(const sysprop::Properties& props,
+// foo.sysprop.h -> foo.sysprop_c.h
+std::string GetCHeaderName(const std::string& header_name) {
+  std::string name = header_name;
+  if (android::base::EndsWith(name, ".h")) name.resize(name.size() - 2);
+  return name + "_c.h";
+}
+
+// Prefix of the names in the C header, since C has no namespaces.
+std::string GetCPrefix(const sysprop::Properties& props) {
+  return std::regex_replace(props.module(), kRegexDot, "_");
+}
+
+// The C type of the value of a scalar, or of the elements of a list, or ""
+// for String and StringList.
+std::string GetCTypeName(const sysprop::Properties& props,
+                         const sysprop::Property& prop) {
+  switch (prop.type()) {
+    case sysprop::Boolean:
+    case sysprop::BooleanList:
+      return "bool";
+    case sysprop::Integer:
+    case sysprop::IntegerList:
+      return "int32_t";
+    case sysprop::Long:
+    case sysprop::LongList:
+      return "int64_t";
+    case sysprop::Double:
+    case sysprop::DoubleList:
+      return "double";
+    case sysprop::Enum:
+    case sysprop::EnumList:
+      return GetCPrefix(props) + "_" + GetCppEnumName(prop);
+    default:
+      return "";
+  }
+}
+
+std::string GetCAccessorParams(const sysprop::Properties& props,
+                               const sysprop::Property& prop, bool setter) {
+  std::string type = GetCTypeName(props, prop);
+  if (prop.type() == sysprop::String) {
+    return setter ? "const char* value" : "char* buf, size_t* size";
+  }
+  if (prop.type() == sysprop::StringList) {
+    return setter ? "const char* const* items, size_t size"
+                  : "char* buf, size_t* buf_size, const char** items, "
+                    "size_t* size";
+  }
+  if (IsListProp(prop)) {
+    return setter ? "const " + type +
+                        "* values, const bool* present, size_t size"
+                  : type + "* values, bool* present, size_t* size";
+  }
+  return setter ? "const " + type + "* value" : type + "* value";
+}
+
+// Each header declares the snapshot and Watcher with the properties visible
+// at its scope, so every scope gets its own inline namespace to keep them
+// apart.
+std::string GetScopeNamespace(sysprop::Scope scope) {
+  switch (scope) {
+    case sysprop::Public:
+      return "public_scope";
+    case sysprop::System:
+      return "system_scope";
+    case sysprop::Internal:
+      return "internal_scope";
+    default:
+      __builtin_unreachable();
+  }
+}
+
+// Snapshots are named after their module, so that sources which use several
+// modules can name each one unqualified. ReadSnapshot() and IsStale() are
+// overloaded on them.
+std::string GetSnapshotName(const sysprop::Properties& props) {
+  return GetModuleName(props) + "Snapshot";
+}
+
+void WriteSnapshotStruct(CodeWriter& writer, const sysprop::Properties& props,
+                         sysprop::Scope scope) {
+  writer.Write("struct %s {\n", GetSnapshotName(props).c_str());
+  writer.Indent();
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.scope() > scope) continue;
+
+    writer.Write("%s %s;\n", GetCppPropTypeName(prop).c_str(),
+                 ApiNameToIdentifier(prop.api_name()).c_str());
+  }
+  writer.Write("std::uint32_t area_serial = 0;\n");
+  writer.Dedent();
+  writer.Write("};\n");
+}
+
+void WriteWatcherClass(CodeWriter& writer, const sysprop::Properties& props,
+                       sysprop::Scope scope) {
+  writer.Write("class Watcher {\n");
+  writer.Write("  public:\n");
+  writer.Indent();
+  writer.Write("Watcher() = default;\n");
+  writer.Write("Watcher(const Watcher&) = delete;\n");
+  writer.Write("Watcher& operator=(const Watcher&) = delete;\n");
+  writer.Write("~Watcher();\n");
+  bool first = true;
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.scope() > scope) continue;
+
+    if (first) writer.Write("\n");
+    first = false;
+    writer.Write(
+        "void %s_OnChange(std::function<void(const %s&)> callback);\n",
+        ApiNameToIdentifier(prop.api_name()).c_str(),
+        GetCppPropTypeName(prop).c_str());
+  }
+  writer.Dedent();
+  writer.Write("\n  private:\n");
+  writer.Indent();
+  writer.Write("std::vector<std::uint64_t> watch_ids_;\n");
+  writer.Dedent();
+  writer.Write("};\n");
+}
+
+// Emits the tag and the handle of every property visible at |scope|, and
+// all_props with all of those handles. Setters are only declared in the
+// internal header, so only its tags have Set().
+void WriteTypedHandles(CodeWriter& writer, const sysprop::Properties& props,
+                       sysprop::Scope scope) {
+  std::vector<std::string> handles;
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.scope() > scope) continue;
+
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+    std::string prop_type = GetCppPropTypeName(prop);
+    bool writable =
+        prop.access() != sysprop::Readonly && scope == sysprop::Internal;
+
+    writer.Write("struct %s_tag {\n", prop_id.c_str());
+    writer.Indent();
+    writer.Write("static constexpr const char* kName = \"%s\";\n",
+                 prop.prop_name().c_str());
+    writer.Write("static constexpr bool kWritable = %s;\n",
+                 writable ? "true" : "false");
+    writer.Write("static %s Get() { return %s(); }\n",
+                 GetCppGetterTypeName(prop).c_str(), prop_id.c_str());
+    if (writable) {
+      writer.Write(
+          "static bool Set(const %s& value) { return %s(value); }\n",
+          prop_type.c_str(), prop_id.c_str());
+    }
+    writer.Dedent();
+    writer.Write("};\n");
+    writer.Write("inline constexpr Prop<%s, %s_tag> %s_prop{};\n\n",
+                 prop_type.c_str(), prop_id.c_str(), prop_id.c_str());
+    handles.push_back(prop_id + "_prop");
+  }
+  writer.Write("inline constexpr auto all_props = std::make_tuple(%s);\n",
+               android::base::Join(handles, ", ").c_str());
+}
+
+// Sources generated without --runtime carry the parts of libsysprop_runtime
+// they use, from the same files the library is built from.
+void WriteRuntimeFragment(CodeWriter& writer, const char* fragment) {
+  writer.Write("%s\n", fragment);
+}
+
+// Emits DoParse for an Enum or EnumList property. Names are dispatched on
+// their length and first character, so that at most a few of them have to
+// be compared in full.
+void WriteEnumParser(CodeWriter& writer, const sysprop::Property& prop,
+                     const std::string& enum_name) {
+  std::map<std::size_t, std::map<char, std::vector<std::string>>> buckets;
+  for (const std::string& name :
+       android::base::Split(prop.enum_values(), "|")) {
+    buckets[name.size()][name[0]].push_back(name);
+  }
+
+  writer.Write("template <>\n");
+  writer.Write("std::optional<%s> DoParse(std::string_view str) {\n",
+               enum_name.c_str());
+  writer.Indent();
+  writer.Write("switch (str.size()) {\n");
+  writer.Indent();
+  for (const auto& [length, names_by_first] : buckets) {
+    writer.Write("case %zu:\n", length);
+    writer.Indent();
+    writer.Write("switch (str[0]) {\n");
+    writer.Indent();
+    for (const auto& [first, names] : names_by_first) {
+      writer.Write("case '%c':\n", first);
+      writer.Indent();
+      for (const std::string& name : names) {
+        if (length == 1) {
+          writer.Write("return %s::%s;\n", enum_name.c_str(),
+                       ToUpper(name).c_str());
+        } else {
+          writer.Write(
+              "if (std::memcmp(str.data() + 1, \"%s\", %zu) == 0) "
+              "return %s::%s;\n",
+              name.c_str() + 1, length - 1, enum_name.c_str(),
+              ToUpper(name).c_str());
+        }
+      }
+      if (length != 1) writer.Write("break;\n");
+      writer.Dedent();
+    }
+    writer.Dedent();
+    writer.Write("}\n");
+    writer.Write("break;\n");
+    writer.Dedent();
+  }
+  writer.Dedent();
+  writer.Write("}\n");
+  writer.Write("return std::nullopt;\n");
+  writer.Dedent();
+  writer.Write("}\n\n");
+}
+
+// Emits the enum tables and the PropDescriptor of every property, which
+// table-driven accessors pass to the runtime.
+void WritePropDescriptors(CodeWriter& writer,
+                          const sysprop::Properties& props,
+                          const CppGenOptions& options) {
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.type() != sysprop::Enum && prop.type() != sysprop::EnumList) {
+      continue;
+    }
+
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+    std::vector<std::string> names =
+        android::base::Split(prop.enum_values(), "|");
+    writer.Write("constexpr const char* %s_names[] = {\n", prop_id.c_str());
+    writer.Indent();
+    for (const std::string& name : names) {
+      writer.Write("\"%s\",\n", name.c_str());
+    }
+    writer.Dedent();
+    writer.Write("};\n\n");
+
+    // ParseEnumName() binary searches the names through this, in the order
+    // std::string_view compares them.
+    std::vector<std::size_t> by_name;
+    for (std::size_t j = 0; j < names.size(); ++j) by_name.push_back(j);
+    std::sort(by_name.begin(), by_name.end(),
+              [&](std::size_t a, std::size_t b) { return names[a] < names[b]; });
+    std::vector<std::string> indices;
+    for (std::size_t index : by_name) indices.push_back(std::to_string(index));
+    writer.Write("constexpr std::uint16_t %s_by_name[] = {%s};\n\n",
+                 prop_id.c_str(), android::base::Join(indices, ", ").c_str());
+
+    writer.Write(
+        "constexpr EnumTable %s_enum_table = {%s_names, %s_by_name, "
+        "std::size(%s_names)};\n\n",
+        prop_id.c_str(), prop_id.c_str(), prop_id.c_str(), prop_id.c_str());
+  }
+
+  writer.Write("constexpr PropDescriptor prop_descriptors[] = {\n");
+  writer.Indent();
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+
+    const char* access = "";
+    switch (prop.access()) {
+      case sysprop::Readonly:
+        access = "kReadonly";
+        break;
+      case sysprop::Writeonce:
+        access = "kWriteonce";
+        break;
+      case sysprop::ReadWrite:
+        access = "kReadWrite";
+        break;
+      default:
+        __builtin_unreachable();
+    }
+
+    std::string enum_table = "nullptr";
+    if (prop.type() == sysprop::Enum || prop.type() == sysprop::EnumList) {
+      enum_table = "&" + ApiNameToIdentifier(prop.api_name()) + "_enum_table";
+    }
+
+    writer.Write("{\"%s\", &prop_handles[%d], PropAccess::%s, %s, %s%s},\n",
+                 prop.prop_name().c_str(), i, access,
+                 prop.integer_as_bool() ? "true" : "false",
+                 enum_table.c_str(), options.elide_writes ? ", true" : "");
+  }
+  writer.Dedent();
+  writer.Write("};\n\n");
+}
+
+void WriteSnapshotFunctions(CodeWriter& writer,
+                            const sysprop::Properties& props,
+                            sysprop::Scope scope) {
+  // The included header only defines the Snapshot of its own scope.
+  if (scope != sysprop::Internal) {
+    WriteSnapshotStruct(writer, props, scope);
+    writer.Write("\n");
+  }
+
+  std::string snapshot_name = GetSnapshotName(props);
+  writer.Write("void ReadSnapshot(%s* snapshot) {\n", snapshot_name.c_str());
+  writer.Indent();
+  // Read the area serial first, so that any change made while reading
+  // leaves the snapshot stale.
+  writer.Write(
+      "std::uint32_t area_serial = __system_property_area_serial();\n");
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.scope() > scope) continue;
+
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+    writer.Write("snapshot->%s = %s();\n", prop_id.c_str(),
+                 prop_id.c_str());
+  }
+  writer.Write("snapshot->area_serial = area_serial;\n");
+  writer.Dedent();
+  writer.Write("}\n\n");
+
+  writer.Write("bool IsStale(const %s& snapshot) {\n", snapshot_name.c_str());
+  writer.Indent();
+  writer.Write(
+      "return snapshot.area_serial == 0 || "
+      "snapshot.area_serial != __system_property_area_serial();\n");
+  writer.Dedent();
+  writer.Write("}\n");
+}
+
+void WriteWatcherFunctions(CodeWriter& writer,
+                           const sysprop::Properties& props,
                            sysprop::Scope scope) {
+  // The included header only defines the Watcher of its own scope.
+  if (scope != sysprop::Internal) {
+    WriteWatcherClass(writer, props, scope);
+    writer.Write("\n");
+  }
+
+  writer.Write("Watcher::~Watcher() {\n");
+  writer.Indent();
+  writer.Write("for (auto id : watch_ids_) RemoveWatch(id);\n");
+  writer.Dedent();
+  writer.Write("}\n");
+
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    if (prop.scope() > scope) continue;
+
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+    writer.Write(
+        "\nvoid Watcher::%s_OnChange(std::function<void(const %s&)> "
+        "callback) {\n",
+        prop_id.c_str(), GetCppPropTypeName(prop).c_str());
+    writer.Indent();
+    writer.Write(
+        "watch_ids_.push_back(AddWatch(prop_handles[%d], "
+        "[callback = std::move(callback)] { callback(%s()); }));\n",
+        i, prop_id.c_str());
+    writer.Dedent();
+    writer.Write("}\n");
+  }
+}
+
+// Emits the extern "C" accessors declared by GenerateCHeader.
+void WriteCAccessors(CodeWriter& writer, const sysprop::Properties& props,
+                     const CppGenOptions& options) {
+  std::string prefix = GetCPrefix(props);
+  std::string cpp_namespace = GetCppNamespace(props);
+
+  writer.Write("extern \"C\" {\n");
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+    std::string c_type = GetCTypeName(props, prop);
+    bool is_enum =
+        prop.type() == sysprop::Enum || prop.type() == sysprop::EnumList;
+    bool is_list = IsListProp(prop);
+    const char* integer_as_bool = prop.integer_as_bool() ? "true" : "false";
+
+    // The C++ type of the value, or of the elements of a list. The C header
+    // includes <stdint.h>, so the C names of integers do for C++ too.
+    std::string cpp_type =
+        is_enum ? cpp_namespace + "::" + GetCppEnumName(prop) : c_type;
+    std::string parse = "DoParse<std::optional<" + cpp_type + ">>";
+    if (is_enum && options.table) {
+      parse = android::base::StringPrintf(
+          "[](std::string_view str) { "
+          "return ParseEnumName(prop_descriptors[%d], str); }",
+          i);
+    }
+
+    writer.Write("\nsysprop_status_t %s_%s_get(%s) {\n", prefix.c_str(),
+                 prop_id.c_str(),
+                 GetCAccessorParams(props, prop, false).c_str());
+    writer.Indent();
+    if (prop.type() == sysprop::String) {
+      writer.Write("return GetCString(prop_handles[%d], buf, size);\n", i);
+    } else if (prop.type() == sysprop::StringList) {
+      writer.Write(
+          "return GetCStringList(prop_handles[%d], buf, buf_size, items, "
+          "size);\n",
+          i);
+    } else if (is_list) {
+      writer.Write(
+          "return GetCList(prop_handles[%d], %s, values, present, size);\n", i,
+          parse.c_str());
+    } else {
+      writer.Write("return GetCValue(prop_handles[%d], %s, value);\n", i,
+                   parse.c_str());
+    }
+    writer.Dedent();
+    writer.Write("}\n");
+
+    if (prop.access() == sysprop::Readonly) continue;
+
+    writer.Write("\nsysprop_status_t %s_%s_set(%s) {\n", prefix.c_str(),
+                 prop_id.c_str(),
+                 GetCAccessorParams(props, prop, true).c_str());
+    writer.Indent();
+    if (prop.type() == sysprop::String) {
+      writer.Write(
+          "return SetCValue(\"%s\", false, [value](ValueBuffer& buf) { "
+          "if (value != nullptr) buf.Append(value); });\n",
+          prop.prop_name().c_str());
+    } else if (prop.type() == sysprop::StringList) {
+      writer.Write("return SetCStringList(\"%s\", items, size);\n",
+                   prop.prop_name().c_str());
+    } else if (is_enum && options.table) {
+      if (is_list) {
+        writer.Write(
+            "return ToCStatus(WriteCEnumList(prop_descriptors[%d], values, "
+            "present, size));\n",
+            i);
+      } else {
+        writer.Write(
+            "return ToCStatus(WriteEnum(prop_descriptors[%d], "
+            "FromCValue<std::size_t>(value)));\n",
+            i);
+      }
+    } else if (is_list) {
+      writer.Write(
+          "return SetCList<%s>(\"%s\", %s, values, present, size);\n",
+          cpp_type.c_str(), prop.prop_name().c_str(), integer_as_bool);
+    } else {
+      writer.Write(
+          "return SetCValue(\"%s\", %s, [value](ValueBuffer& buf) { "
+          "FormatValue(buf, FromCValue<%s>(value)); });\n",
+          prop.prop_name().c_str(), integer_as_bool, cpp_type.c_str());
+    }
+    writer.Dedent();
+    writer.Write("}\n");
+  }
+  writer.Write("\n}  // extern \"C\"\n");
+}
+
+// Declares C accessors of every property, for C code and FFI. They take and
+// fill buffers of the caller, and return a sysprop_status_t.
+std::string GenerateCHeader(const sysprop::Properties& props) {
+  CodeWriter writer(kIndent);
+  std::string prefix = GetCPrefix(props);
+
+  writer.Write("%s", kGeneratedFileFooterComments);
+  writer.Write("#pragma once\n\n");
+  writer.Write("#include <stdbool.h>\n");
+  writer.Write("#include <stddef.h>\n");
+  writer.Write("#include <stdint.h>\n\n");
+  writer.Write("%s", kCStatus);
+  writer.Write(
+      "// Getters parse the value like the C++ getters do. Strings are "
+      "copied to\n"
+      "// |buf|, NUL-terminated, and lists to |values| with |present| "
+      "false for empty\n"
+      "// or invalid elements. Sizes are passed in as capacities and "
+      "come back as what\n"
+      "// the value takes, including the NUL of strings. Setters take "
+      "NULL for an\n"
+      "// empty value.\n\n");
+  writer.Write("#ifdef __cplusplus\n");
+  writer.Write("extern \"C\" {\n");
+  writer.Write("#endif\n");
+
+  for (int i = 0; i < props.prop_size(); ++i) {
+    const sysprop::Property& prop = props.prop(i);
+    std::string prop_id = ApiNameToIdentifier(prop.api_name());
+
+    writer.Write("\n");
+    if (prop.type() == sysprop::Enum || prop.type() == sysprop::EnumList) {
+      writer.Write("typedef enum {\n");
+      writer.Indent();
+      for (const std::string& name :
+           android::base::Split(prop.enum_values(), "|")) {
+        writer.Write("%s_%s_%s,\n", prefix.c_str(), prop_id.c_str(),
+                     ToUpper(name).c_str());
+      }
+      writer.Dedent();
+      writer.Write("} %s;\n\n", GetCTypeName(props, prop).c_str());
+    }
+    writer.Write("sysprop_status_t %s_%s_get(%s);\n", prefix.c_str(),
+                 prop_id.c_str(),
+                 GetCAccessorParams(props, prop, false).c_str());
+    if (prop.access() != sysprop::Readonly) {
+      writer.Write("sysprop_status_t %s_%s_set(%s);\n", prefix.c_str(),
+                   prop_id.c_str(),
+                   GetCAccessorParams(props, prop, true).c_str());
+    }
+  }
+
+  writer.Write("\n#ifdef __cplusplus\n");
+  writer.Write("}  // extern \"C\"\n");
+  writer.Write("#endif\n");
+  return writer.Code();
+}
+
+std::string GenerateHeader(const sysprop::Properties& props,
+                           sysprop::Scope scope, const CppGenOptions& options) {
   CodeWriter writer(kIndent);
 
   writer.Write("%s", kGeneratedFileFooterComments);
 
   writer.Write("#pragma once\n\n");
   writer.Write("%s", kCppHeaderIncludes);
+  if (options.wait_for || options.watcher) {
+    if (options.wait_for) writer.Write("#include <chrono>\n");
+    writer.Write("#include <functional>\n\n");
+  }
+  if (options.pmr) writer.Write("#include <memory_resource>\n\n");
+  if (options.inline_lists || options.compact) {
+    if (options.compact) writer.Write("#include <bitset>\n");
+    if (options.inline_lists) {
+      writer.Write("#include <cstring>\n");
+      writer.Write("#include <new>\n");
+      writer.Write("#include <string_view>\n");
+      writer.Write("#include <type_traits>\n");
+    }
+    writer.Write("\n#include <sys/system_properties.h>\n\n");
+  }
+  if (options.typed_handles) writer.Write("#include <tuple>\n\n");
+  if (options.async_writes) {
+    writer.Write("#include <sysprop/AsyncWrite.h>\n\n");
+  }
 
   std::string cpp_namespace = GetCppNamespace(props);
   writer.Write("namespace %s {\n\n", cpp_namespace.c_str());
 
+  if (options.async_writes && scope == sysprop::Internal) {
+    writer.Write("using android::sysprop::runtime::WriteToken;\n\n");
+  }
+
+  if (options.inline_lists) writer.Write("%s\n", kCppInlineList);
+  if (options.compact) writer.Write("%s\n", kCppCompactTypes);
+  if (options.typed_handles) writer.Write("%s\n", kCppTypedProp);
+
   bool first = true;
 
   for (int i = 0; i < props.prop_size(); ++i) {
@@ -266,90 +1214,158 @@ std::string GenerateHeader(const sysprop::Properties& props,
     std::string prop_type = GetCppPropTypeName(prop);
 
     if (prop.type() == sysprop::Enum || prop.type() == sysprop::EnumList) {
-      writer.Write("enum class %s {\n", GetCppEnumName(prop).c_str());
+      std::vector<std::string> names =
+          android::base::Split(prop.enum_values(), "|");
+      // Compact enums take a byte unless they have too many values.
+      const char* underlying_type = "";
+      if (options.compact) {
+        underlying_type =
+            names.size() <= 256 ? " : std::uint8_t" : " : std::uint16_t";
+      }
+      writer.Write("enum class %s%s {\n", GetCppEnumName(prop).c_str(),
+                   underlying_type);
       writer.Indent();
-      for (const std::string& name :
-           android::base::Split(prop.enum_values(), "|")) {
+      for (const std::string& name : names) {
         writer.Write("%s,\n", ToUpper(name).c_str());
       }
       writer.Dedent();
       writer.Write("};\n\n");
     }
 
-    writer.Write("%s %s();\n", prop_type.c_str(), prop_id.c_str());
+    writer.Write("%s %s();\n", GetCppGetterTypeName(prop).c_str(),
+                 prop_id.c_str());
+    std::string pmr_type = GetCppPmrTypeName(prop);
+    if (options.pmr && !pmr_type.empty()) {
+      writer.Write("%s %s(std::pmr::memory_resource& resource);\n",
+                   pmr_type.c_str(), prop_id.c_str());
+    }
+    std::string inline_list_type = GetCppInlineListTypeName(prop);
+    if (options.inline_lists && !inline_list_type.empty()) {
+      writer.Write("%s %s_Inline();\n", inline_list_type.c_str(),
+                   prop_id.c_str());
+    }
+    std::string compact_type = GetCppCompactTypeName(prop);
+    if (options.compact && !compact_type.empty()) {
+      writer.Write("%s %s();\n", compact_type.c_str(),
+                   GetCppCompactGetterName(prop).c_str());
+    }
     if (prop.access() != sysprop::Readonly && scope == sysprop::Internal) {
       writer.Write("bool %s(const %s& value);\n", prop_id.c_str(),
                    prop_type.c_str());
+      if (options.async_writes) {
+        writer.Write("WriteToken %s_SetAsync(const %s& value);\n",
+                     prop_id.c_str(), prop_type.c_str());
+      }
+    }
+    if (options.wait_for) {
+      writer.Write(
+          "bool %s_WaitFor(const std::function<bool(const %s&)>& predicate, "
+          "std::chrono::nanoseconds timeout);\n",
+          prop_id.c_str(), prop_type.c_str());
     }
   }
 
+  if (options.prewarm) writer.Write("\nvoid Prewarm();\n");
+  if (options.async_writes && scope == sysprop::Internal) {
+    writer.Write("\nvoid Flush();\n");
+  }
+
+  if (options.snapshot || options.watcher || options.typed_handles) {
+    std::string scope_namespace = GetScopeNamespace(scope);
+    writer.Write("\ninline namespace %s {\n", scope_namespace.c_str());
+    if (options.snapshot) {
+      writer.Write("\n");
+      WriteSnapshotStruct(writer, props, scope);
+      std::string snapshot_name = GetSnapshotName(props);
+      writer.Write("\nvoid ReadSnapshot(%s* snapshot);\n",
+                   snapshot_name.c_str());
+      writer.Write("bool IsStale(const %s& snapshot);\n",
+                   snapshot_name.c_str());
+    }
+    if (options.watcher) {
+      writer.Write("\n");
+      WriteWatcherClass(writer, props, scope);
+    }
+    if (options.typed_handles) {
+      writer.Write("\n");
+      WriteTypedHandles(writer, props, scope);
+    }
+    writer.Write("\n}  // namespace %s\n", scope_namespace.c_str());
+  }
+
   writer.Write("\n}  // namespace %s\n", cpp_namespace.c_str());
 
   return writer.Code();
 }
 
 std::string GenerateSource(const sysprop::Properties& props,
-                           const std::string& include_name) {
+                           const std::string& include_name,
+                           const CppGenOptions& options) {
   CodeWriter writer(kIndent);
   writer.Write("%s", kGeneratedFileFooterComments);
-  writer.Write("#include <%s>\n\n", include_name.c_str());
-  writer.Write("%s", kCppSourceIncludes);
+  writer.Write("#include <%s>\n", include_name.c_str());
+  if (options.c_api) {
+    writer.Write("#include <%s>\n", GetCHeaderName(include_name).c_str());
+  }
+  writer.Write("\n");
+  writer.Write("%s", options.runtime ? kCppRuntimeSourceIncludes
+                                      : kCppSourceIncludes);
 
   std::string cpp_namespace = GetCppNamespace(props);
 
-  writer.Write("namespace {\n\n");
-  writer.Write("using namespace %s;\n\n", cpp_namespace.c_str());
-  writer.Write("template <typename T> T DoParse(const char* str);\n\n");
+  bool has_enums = std::any_of(
+      props.prop().begin(), props.prop().end(), [](const auto& prop) {
+        return prop.type() == sysprop::Enum || prop.type() == sysprop::EnumList;
+      });
+
+  // Enum parsers and formatters have to be found by the runtime's templates,
+  // so they go to its namespace and name the enums in full. Table-driven
+  // accessors only need the enum names.
+  if (options.runtime) {
+    if (has_enums && !options.table) {
+      writer.Write("namespace android::sysprop::runtime {\n\n");
+    }
+  } else {
+    writer.Write("namespace {\n\n");
+    writer.Write("using namespace %s;\n\n", cpp_namespace.c_str());
+    WriteRuntimeFragment(writer, kParseFragment);
+  }
 
   for (int i = 0; i < props.prop_size(); ++i) {
     const sysprop::Property& prop = props.prop(i);
     if (prop.type() != sysprop::Enum && prop.type() != sysprop::EnumList) {
       continue;
     }
+    if (options.table) continue;
 
     std::string prop_id = ApiNameToIdentifier(prop.api_name());
     std::string enum_name = GetCppEnumName(prop);
+    if (options.runtime) enum_name = cpp_namespace + "::" + enum_name;
 
-    writer.Write("constexpr const std::pair<const char*, %s> %s_list[] = {\n",
-                 enum_name.c_str(), prop_id.c_str());
-    writer.Indent();
-    for (const std::string& name :
-         android::base::Split(prop.enum_values(), "|")) {
-      writer.Write("{\"%s\", %s::%s},\n", name.c_str(), enum_name.c_str(),
-                   ToUpper(name).c_str());
-    }
-    writer.Dedent();
-    writer.Write("};\n\n");
-
-    writer.Write("template <>\n");
-    writer.Write("std::optional<%s> DoParse(const char* str) {\n",
-                 enum_name.c_str());
-    writer.Indent();
-    writer.Write("for (auto [name, val] : %s_list) {\n", prop_id.c_str());
-    writer.Indent();
-    writer.Write("if (strcmp(str, name) == 0) {\n");
-    writer.Indent();
-    writer.Write("return val;\n");
-    writer.Dedent();
-    writer.Write("}\n");
-    writer.Dedent();
-    writer.Write("}\n");
-    writer.Write("return std::nullopt;\n");
-    writer.Dedent();
-    writer.Write("}\n\n");
+    WriteEnumParser(writer, prop, enum_name);
 
     if (prop.access() != sysprop::Readonly) {
-      writer.Write("std::string FormatValue(std::optional<%s> value) {\n",
-                   enum_name.c_str());
+      // Enumerators are numbered in declaration order, so they index the
+      // names directly.
+      writer.Write("constexpr const char* %s_names[] = {\n", prop_id.c_str());
       writer.Indent();
-      writer.Write("if (!value) return \"\";\n");
-      writer.Write("for (auto [name, val] : %s_list) {\n", prop_id.c_str());
+      for (const std::string& name :
+           android::base::Split(prop.enum_values(), "|")) {
+        writer.Write("\"%s\",\n", name.c_str());
+      }
+      writer.Dedent();
+      writer.Write("};\n\n");
+
+      writer.Write(
+          "void FormatValue(ValueBuffer& buf, std::optional<%s> value) {\n",
+          enum_name.c_str());
       writer.Indent();
-      writer.Write("if (val == *value) {\n");
+      writer.Write("if (!value) return;\n");
+      writer.Write("auto index = static_cast<std::size_t>(*value);\n");
+      writer.Write("if (index < std::size(%s_names)) {\n", prop_id.c_str());
       writer.Indent();
-      writer.Write("return name;\n");
-      writer.Dedent();
-      writer.Write("}\n");
+      writer.Write("buf.Append(%s_names[index]);\n", prop_id.c_str());
+      writer.Write("return;\n");
       writer.Dedent();
       writer.Write("}\n");
 
@@ -358,12 +1374,58 @@ std::string GenerateSource(const sysprop::Properties& props,
           "static_cast<std::int32_t>(*value));\n",
           prop.prop_name().c_str());
 
-      writer.Write("__builtin_unreachable();\n");
       writer.Dedent();
       writer.Write("}\n\n");
     }
   }
-  writer.Write("%s", kCppParsersAndFormatters);
+  if (options.runtime) {
+    if (has_enums && !options.table) {
+      writer.Write("}  // namespace android::sysprop::runtime\n\n");
+    }
+    writer.Write("namespace {\n\n");
+    writer.Write("using namespace android::sysprop::runtime;\n\n");
+  } else {
+    WriteRuntimeFragment(writer, kParseImplFragment);
+    WriteRuntimeFragment(writer, kPropHandleFragment);
+    WriteRuntimeFragment(writer, kPropHandleImplFragment);
+    // SetPropIfChanged takes the cache of the getter.
+    if (options.cache_values || options.elide_writes ||
+        HasCachePolicy(props, sysprop::Serial)) {
+      WriteRuntimeFragment(writer, kPropCacheFragment);
+    }
+    if (options.elide_writes) {
+      WriteRuntimeFragment(writer, kSetIfChangedFragment);
+      WriteRuntimeFragment(writer, kSetIfChangedImplFragment);
+    }
+    if (HasCachePolicy(props, sysprop::Boot)) {
+      WriteRuntimeFragment(writer, kBootValueFragment);
+    }
+    if (options.wait_for) {
+      WriteRuntimeFragment(writer, kWaitForFragment);
+      WriteRuntimeFragment(writer, kWaitForImplFragment);
+    }
+    if (options.inline_lists || options.compact) {
+      WriteRuntimeFragment(writer, kInlineListFragment);
+      WriteRuntimeFragment(writer, kInlineListImplFragment);
+    }
+    if (options.pmr) WriteRuntimeFragment(writer, kPmrFragment);
+  }
+
+  writer.Write("PropHandle prop_handles[] = {\n");
+  writer.Indent();
+  for (int i = 0; i < props.prop_size(); ++i) {
+    writer.Write("{\"%s\"},\n", props.prop(i).prop_name().c_str());
+  }
+  writer.Dedent();
+  writer.Write("};\n\n");
+
+  if (options.table) WritePropDescriptors(writer, props, options);
+
+  if (options.c_api) {
+    writer.Write("%s", kCppCAccessors);
+    if (options.table) writer.Write("%s", kCppCTableAccessors);
+  }
+
   writer.Write("}  // namespace\n\n");
 
   writer.Write("namespace %s {\n\n", cpp_namespace.c_str());
@@ -374,45 +1436,198 @@ std::string GenerateSource(const sysprop::Properties& props,
     const sysprop::Property& prop = props.prop(i);
     std::string prop_id = ApiNameToIdentifier(prop.api_name());
     std::string prop_type = GetCppPropTypeName(prop);
+    bool writes_through = WritesThrough(prop, options);
 
-    writer.Write("%s %s() {\n", prop_type.c_str(), prop_id.c_str());
+    // The setter updates the cache too, so it can't be local to the getter.
+    if (writes_through) {
+      writer.Write("static PropCache<%s> %s_cache;\n\n",
+                   prop_type.c_str(), prop_id.c_str());
+    }
+
+    writer.Write("%s %s() {\n", GetCppGetterTypeName(prop).c_str(),
+                 prop_id.c_str());
     writer.Indent();
-    writer.Write("return GetProp<%s>(\"%s\");\n", prop_type.c_str(),
-                 prop.prop_name().c_str());
+    // Table-driven caches parse through ReadValue.
+    std::string read_arg;
+    if (options.table) {
+      read_arg = android::base::StringPrintf(
+          ", [] { return ReadValue<%s>(prop_descriptors[%d]); }",
+          prop_type.c_str(), i);
+    }
+    if (prop.cache_policy() == sysprop::Boot) {
+      writer.Write("static BootValue<%s> value;\n", prop_type.c_str());
+      writer.Write("return value.Get(prop_handles[%d]%s);\n", i,
+                   read_arg.c_str());
+    } else if (writes_through) {
+      writer.Write("return %s_cache.Get(prop_handles[%d]%s);\n",
+                   prop_id.c_str(), i, read_arg.c_str());
+    } else if (options.cache_values ||
+               prop.cache_policy() == sysprop::Serial) {
+      writer.Write("static PropCache<%s> cache;\n", prop_type.c_str());
+      writer.Write("return cache.Get(prop_handles[%d]%s);\n", i,
+                   read_arg.c_str());
+    } else if (options.table) {
+      writer.Write("return ReadValue<%s>(prop_descriptors[%d]);\n",
+                   prop_type.c_str(), i);
+    } else {
+      writer.Write("return GetProp<%s>(prop_handles[%d]);\n",
+                   prop_type.c_str(), i);
+    }
     writer.Dedent();
     writer.Write("}\n");
 
+    std::string pmr_type = GetCppPmrTypeName(prop);
+    if (options.pmr && !pmr_type.empty()) {
+      writer.Write("\n%s %s(std::pmr::memory_resource& resource) {\n",
+                   pmr_type.c_str(), prop_id.c_str());
+      writer.Indent();
+      if (options.table && prop.type() == sysprop::EnumList) {
+        writer.Write("return ReadValue<%s>(prop_descriptors[%d], resource);\n",
+                     pmr_type.c_str(), i);
+      } else {
+        writer.Write("return GetProp<%s>(prop_handles[%d], resource);\n",
+                     pmr_type.c_str(), i);
+      }
+      writer.Dedent();
+      writer.Write("}\n");
+    }
+
+    std::string inline_list_type = GetCppInlineListTypeName(prop);
+    if (options.inline_lists && !inline_list_type.empty()) {
+      writer.Write("\n%s %s_Inline() {\n", inline_list_type.c_str(),
+                   prop_id.c_str());
+      writer.Indent();
+      // Table-driven sources have no enum parsers, only the enum tables.
+      if (options.table && prop.type() == sysprop::EnumList) {
+        writer.Write("return ReadValue<%s>(prop_descriptors[%d]);\n",
+                     inline_list_type.c_str(), i);
+      } else {
+        writer.Write("return GetInlineList<%s>(prop_handles[%d]);\n",
+                     inline_list_type.c_str(), i);
+      }
+      writer.Dedent();
+      writer.Write("}\n");
+    }
+
+    std::string compact_type = GetCppCompactTypeName(prop);
+    if (options.compact && !compact_type.empty()) {
+      writer.Write("\n%s %s() {\n", compact_type.c_str(),
+                   GetCppCompactGetterName(prop).c_str());
+      writer.Indent();
+      if (options.table && prop.type() == sysprop::EnumList) {
+        writer.Write("return ReadValue<%s>(prop_descriptors[%d]);\n",
+                     compact_type.c_str(), i);
+      } else {
+        writer.Write("return GetInlineList<%s>(prop_handles[%d]);\n",
+                     compact_type.c_str(), i);
+      }
+      writer.Dedent();
+      writer.Write("}\n");
+    }
+
     if (prop.access() != sysprop::Readonly) {
       writer.Write("\nbool %s(const %s& value) {\n", prop_id.c_str(),
                    prop_type.c_str());
       writer.Indent();
 
-      const char* format_expr = "FormatValue(value).c_str()";
-
-      // Specialized formatters here
-      if (prop.type() == sysprop::String) {
-        format_expr = "value ? value->c_str() : \"\"";
+      if (writes_through) {
+        writer.Write(
+            "return SetPropIfChanged(prop_handles[%d], \"%s\", value, %s, "
+            "&%s_cache);\n",
+            i, prop.prop_name().c_str(),
+            prop.integer_as_bool() ? "true" : "false", prop_id.c_str());
+      } else if (options.table) {
+        writer.Write("return WriteValue(prop_descriptors[%d], value);\n", i);
+      } else if (options.elide_writes) {
+        writer.Write(
+            "return SetPropIfChanged(prop_handles[%d], \"%s\", value%s);\n", i,
+            prop.prop_name().c_str(), prop.integer_as_bool() ? ", true" : "");
       } else if (prop.integer_as_bool()) {
-        if (prop.type() == sysprop::Boolean) {
-          // optional<bool> -> optional<int>
-          format_expr = "FormatValue(std::optional<int>(value)).c_str()";
-        } else if (prop.type() == sysprop::BooleanList) {
-          // vector<optional<bool>> -> vector<optional<int>>
-          format_expr =
-              "FormatValue(std::vector<std::optional<int>>("
-              "value.begin(), value.end())).c_str()";
+        writer.Write("return SetProp(\"%s\", value, true);\n",
+                     prop.prop_name().c_str());
+      } else {
+        writer.Write("return SetProp(\"%s\", value);\n",
+                     prop.prop_name().c_str());
+      }
+      writer.Dedent();
+      writer.Write("}\n");
+
+      if (options.async_writes) {
+        writer.Write("\nWriteToken %s_SetAsync(const %s& value) {\n",
+                     prop_id.c_str(), prop_type.c_str());
+        writer.Indent();
+        writer.Write("static auto& slot = *new AsyncWriteSlot(\"%s\");\n",
+                     prop.prop_name().c_str());
+        // Table-driven sources leave formatting enums to the runtime.
+        if (options.table && (prop.type() == sysprop::Enum ||
+                              prop.type() == sysprop::EnumList)) {
+          writer.Write(
+              "return WriteValueAsync(prop_descriptors[%d], slot, value);\n",
+              i);
+        } else if (prop.integer_as_bool()) {
+          writer.Write("return SetPropAsync(slot, value, true);\n");
+        } else {
+          writer.Write("return SetPropAsync(slot, value);\n");
         }
+        writer.Dedent();
+        writer.Write("}\n");
       }
+    }
 
-      writer.Write("return __system_property_set(\"%s\", %s) == 0;\n",
-                   prop.prop_name().c_str(), format_expr);
+    if (options.wait_for) {
+      writer.Write(
+          "\nbool %s_WaitFor(const std::function<bool(const %s&)>& predicate, "
+          "std::chrono::nanoseconds timeout) {\n",
+          prop_id.c_str(), prop_type.c_str());
+      writer.Indent();
+      writer.Write(
+          "return WaitForProp<%s>(prop_handles[%d], [] { return %s(); }, "
+          "predicate, timeout);\n",
+          prop_type.c_str(), i, prop_id.c_str());
       writer.Dedent();
       writer.Write("}\n");
     }
   }
 
+  if (options.prewarm) {
+    writer.Write("\nvoid Prewarm() {\n");
+    writer.Indent();
+    writer.Write("for (auto& handle : prop_handles) handle.Find();\n");
+    writer.Dedent();
+    writer.Write("}\n");
+  }
+
+  if (options.async_writes) {
+    writer.Write("\nvoid Flush() {\n");
+    writer.Indent();
+    writer.Write("FlushAsyncWrites();\n");
+    writer.Dedent();
+    writer.Write("}\n");
+  }
+
+  if (options.snapshot || options.watcher) {
+    for (sysprop::Scope scope : {sysprop::Internal, sysprop::System}) {
+      std::string scope_namespace = GetScopeNamespace(scope);
+      writer.Write("\ninline namespace %s {\n", scope_namespace.c_str());
+      if (options.snapshot) {
+        writer.Write("\n");
+        WriteSnapshotFunctions(writer, props, scope);
+      }
+      if (options.watcher) {
+        writer.Write("\n");
+        WriteWatcherFunctions(writer, props, scope);
+      }
+      writer.Write("\n}  // namespace %s\n", scope_namespace.c_str());
+    }
+  }
+
   writer.Write("\n}  // namespace %s\n", cpp_namespace.c_str());
 
+  if (options.c_api) {
+    writer.Write("\n");
+    WriteCAccessors(writer, props, options);
+  }
+
   return writer.Code();
 }
 
@@ -422,7 +1637,20 @@ bool GenerateCppFiles(const std::string& input_file_path,
                       const std::string& header_dir,
                       const std::string& system_header_dir,
                       const std::string& source_output_dir,
-                      const std::string& include_name, std::string* err) {
+                      const std::string& include_name,
+                      const CppGenOptions& options, std::string* err) {
+  if (options.table && !options.runtime) {
+    *err = "Table-driven accessors require the runtime library";
+    return false;
+  }
+  if (options.watcher && !options.runtime) {
+    *err = "Watcher requires the runtime library";
+    return false;
+  }
+  if (options.async_writes && !options.runtime) {
+    *err = "SetAsync requires the runtime library";
+    return false;
+  }
   sysprop::Properties props;
 
   if (!ParseProps(input_file_path, &props, err)) {
@@ -441,7 +1669,7 @@ bool GenerateCppFiles(const std::string& input_file_path,
     }
 
     std::string path = dir + "/" + output_basename + ".h";
-    std::string result = GenerateHeader(props, scope);
+    std::string result = GenerateHeader(props, scope, options);
 
     if (!android::base::WriteStringToFile(result, path)) {
       *err =
@@ -450,8 +1678,19 @@ bool GenerateCppFiles(const std::string& input_file_path,
     }
   }
 
+  // The C header is only for the owner of the properties.
+  if (options.c_api) {
+    std::string path =
+        header_dir + "/" + GetCHeaderName(output_basename + ".h");
+    if (!android::base::WriteStringToFile(GenerateCHeader(props), path)) {
+      *err = "Writing generated C header to " + path +
+             " failed: " + strerror(errno);
+      return false;
+    }
+  }
+
   std::string source_path = source_output_dir + "/" + output_basename + ".cpp";
-  std::string source_result = GenerateSource(props, include_name);
+  std::string source_result = GenerateSource(props, include_name, options);
 
   if (!android::base::WriteStringToFile(source_result, source_path)) {
     *err = "Writing generated source to " + source_path +
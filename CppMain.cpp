@@ -33,12 +33,16 @@ struct Arguments {
   std::string system_header_dir;
   std::string source_dir;
   std::string include_name;
+  CppGenOptions options;
 };
 
 [[noreturn]] void PrintUsage(const char* exe_name) {
   std::printf(
       "Usage: %s --header-dir dir --source-dir dir "
       "--include-name name --system-header-dir dir "
+      "[--cache-values] [--prewarm] [--snapshot] [--runtime] [--table] "
+      "[--wait-for] [--watcher] [--inline-lists] [--pmr] [--compact] "
+      "[--elide-writes] [--async-writes] [--typed-handles] [--c-api] "
       "sysprop_file\n",
       exe_name);
   std::exit(EXIT_FAILURE);
@@ -51,6 +55,21 @@ bool ParseArgs(int argc, char* argv[], Arguments* args, std::string* err) {
         {"system-header-dir", required_argument, 0, 's'},
         {"source-dir", required_argument, 0, 'c'},
         {"include-name", required_argument, 0, 'n'},
+        {"cache-values", no_argument, 0, 'v'},
+        {"prewarm", no_argument, 0, 'p'},
+        {"snapshot", no_argument, 0, 'S'},
+        {"runtime", no_argument, 0, 'r'},
+        {"table", no_argument, 0, 't'},
+        {"wait-for", no_argument, 0, 'w'},
+        {"watcher", no_argument, 0, 'W'},
+        {"inline-lists", no_argument, 0, 'i'},
+        {"pmr", no_argument, 0, 'm'},
+        {"compact", no_argument, 0, 'C'},
+        {"elide-writes", no_argument, 0, 'e'},
+        {"async-writes", no_argument, 0, 'a'},
+        {"typed-handles", no_argument, 0, 'T'},
+        {"c-api", no_argument, 0, 'A'},
+        {0, 0, 0, 0},
     };
 
     int opt = getopt_long_only(argc, argv, "", long_options, nullptr);
@@ -69,6 +88,48 @@ bool ParseArgs(int argc, char* argv[], Arguments* args, std::string* err) {
       case 'n':
         args->include_name = optarg;
         break;
+      case 'v':
+        args->options.cache_values = true;
+        break;
+      case 'p':
+        args->options.prewarm = true;
+        break;
+      case 'S':
+        args->options.snapshot = true;
+        break;
+      case 'r':
+        args->options.runtime = true;
+        break;
+      case 't':
+        args->options.table = true;
+        break;
+      case 'w':
+        args->options.wait_for = true;
+        break;
+      case 'W':
+        args->options.watcher = true;
+        break;
+      case 'i':
+        args->options.inline_lists = true;
+        break;
+      case 'm':
+        args->options.pmr = true;
+        break;
+      case 'C':
+        args->options.compact = true;
+        break;
+      case 'e':
+        args->options.elide_writes = true;
+        break;
+      case 'a':
+        args->options.async_writes = true;
+        break;
+      case 'T':
+        args->options.typed_handles = true;
+        break;
+      case 'A':
+        args->options.c_api = true;
+        break;
       default:
         PrintUsage(argv[0]);
     }
@@ -106,7 +167,7 @@ int main(int argc, char* argv[]) {
 
   if (!GenerateCppFiles(args.input_file_path, args.header_dir,
                         args.system_header_dir, args.source_dir,
-                        args.include_name, &err)) {
+                        args.include_name, args.options, &err)) {
     LOG(FATAL) << "Error during generating cpp sysprop from "
                << args.input_file_path << ": " << err;
   }
@@ -22,9 +22,12 @@
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <regex>
 #include <string>
+#include <utility>
 
 #include "CodeWriter.h"
 #include "Common.h"
@@ -39,84 +42,178 @@ constexpr const char* kJavaFileImports =
 
 import android.os.SystemProperties;
 import java.util.ArrayList;
+import java.util.BitSet;
 import java.util.function.Function;
 import java.util.List;
 import java.util.Locale;
 import java.util.Optional;
+import java.util.OptionalDouble;
+import java.util.OptionalInt;
+import java.util.OptionalLong;
 import java.util.StringJoiner;
 import java.util.stream.Collectors;
 
 )";
 
+constexpr const char* kJavaCachedValue =
+    R"(
+private static final class CachedValue<T> {
+    final String propValue;
+    final T value;
+
+    CachedValue(String propValue, T value) {
+        this.propValue = propValue;
+        this.value = value;
+    }
+}
+)";
+
 constexpr const char* kJavaParsersAndFormatters =
     R"(private static Boolean tryParseBoolean(String str) {
-    switch (str.toLowerCase(Locale.US)) {
-        case "1":
-        case "true":
-            return Boolean.TRUE;
-        case "0":
-        case "false":
-            return Boolean.FALSE;
+    return tryParseBoolean(str, 0, str.length());
+}
+
+// Parses str[begin, end) like Boolean.parseBoolean(str.toLowerCase(Locale.US)) would, but also
+// takes "1" and "0", and returns null for anything else.
+private static Boolean tryParseBoolean(String str, int begin, int end) {
+    switch (end - begin) {
+        case 1:
+            switch (str.charAt(begin)) {
+                case '1':
+                    return Boolean.TRUE;
+                case '0':
+                    return Boolean.FALSE;
+                default:
+                    return null;
+            }
+        case 4:
+            return equalsLowerCase(str, begin, "true") ? Boolean.TRUE : null;
+        case 5:
+            return equalsLowerCase(str, begin, "false") ? Boolean.FALSE : null;
         default:
             return null;
     }
 }
 
-private static Integer tryParseInteger(String str) {
-    try {
-        return Integer.valueOf(str);
-    } catch (NumberFormatException e) {
-        return null;
+// Whether str.substring(begin).toLowerCase(Locale.US) would start with |lower|, which is ASCII.
+private static boolean equalsLowerCase(String str, int begin, String lower) {
+    for (int i = 0; i < lower.length(); ++i) {
+        if ((str.charAt(begin + i) | 0x20) != lower.charAt(i)) return false;
     }
+    return true;
+}
+
+// Same as Integer.valueOf(str), with null in place of NumberFormatException.
+private static Integer tryParseInteger(String str) {
+    long scanned = scanDecimal(str, 0, str.length(), Integer.MIN_VALUE, Integer.MAX_VALUE);
+    return scanned <= 0 ? Integer.valueOf((int) decimalValue(str, 0, scanned)) : null;
 }
 
 private static Long tryParseLong(String str) {
-    try {
-        return Long.valueOf(str);
-    } catch (NumberFormatException e) {
-        return null;
-    }
+    long scanned = scanDecimal(str, 0, str.length(), Long.MIN_VALUE, Long.MAX_VALUE);
+    return scanned <= 0 ? Long.valueOf(decimalValue(str, 0, scanned)) : null;
 }
 
-private static Double tryParseDouble(String str) {
-    try {
-        return Double.valueOf(str);
-    } catch (NumberFormatException e) {
-        return null;
+// Parses str[begin, end) like Long.parseLong(str.substring(begin, end)) would, and accepts
+// values in [min, max]: an optional sign, then digits as told by Character.digit. Accumulates
+// negatively like Long.parseLong, so that MIN_VALUE doesn't overflow, and returns the negated
+// magnitude, which is never positive, or 1 if the string is rejected.
+private static long scanDecimal(String str, int begin, int end, long min, long max) {
+    if (begin == end) return 1;
+    int i = begin;
+    boolean negative = false;
+    char first = str.charAt(begin);
+    if (first == '-' || first == '+') {
+        if (end - begin == 1) return 1;
+        negative = first == '-';
+        ++i;
     }
+    long limit = negative ? min : -max;
+    long multmin = limit / 10;
+    long result = 0;
+    for (; i < end; ++i) {
+        int digit = Character.digit(str.charAt(i), 10);
+        if (digit < 0 || result < multmin) return 1;
+        result *= 10;
+        if (result < limit + digit) return 1;
+        result -= digit;
+    }
+    return result;
 }
 
-private static String tryParseString(String str) {
-    return "".equals(str) ? null : str;
+// The value of str[begin, end), from what scanDecimal returned for it.
+private static long decimalValue(String str, int begin, long scanned) {
+    return str.charAt(begin) == '-' ? scanned : -scanned;
 }
 
-private static <T extends Enum<T>> T tryParseEnum(Class<T> enumType, String str) {
-    try {
-        return Enum.valueOf(enumType, str.toUpperCase(Locale.US));
-    } catch (IllegalArgumentException e) {
-        return null;
-    }
+// Only strings which Double.valueOf(str) accepts are converted, so it never throws.
+private static Double tryParseDouble(String str) {
+    return isDoubleString(str) ? Double.valueOf(str) : null;
 }
 
-private static <T> List<T> tryParseList(Function<String, T> elementParser, String str) {
-    if ("".equals(str)) return new ArrayList<>();
+// The grammar of Double.valueOf(str): surrounding characters up to ' ' are ignored, then an
+// optional sign, and NaN, Infinity, a decimal number with an optional exponent, or a hex
+// number with a binary exponent, the last two with an optional [fFdD] suffix.
+private static boolean isDoubleString(String str) {
+    return isDoubleString(str, 0, str.length());
+}
 
-    List<T> ret = new ArrayList<>();
+// Same as isDoubleString(str.substring(begin, end)).
+private static boolean isDoubleString(String str, int begin, int end) {
+    int i = begin;
+    while (i < end && str.charAt(i) <= ' ') ++i;
+    while (end > i && str.charAt(end - 1) <= ' ') --end;
+    if (i < end && (str.charAt(i) == '+' || str.charAt(i) == '-')) ++i;
+    if (str.startsWith("NaN", i)) return i + 3 == end;
+    if (str.startsWith("Infinity", i)) return i + 8 == end;
+
+    boolean hex = end - i > 2 && str.charAt(i) == '0' && (str.charAt(i + 1) | 0x20) == 'x';
+    if (hex) i += 2;
+    int digitsEnd = skipDigits(str, i, end, hex);
+    int digits = digitsEnd - i;
+    i = digitsEnd;
+    if (i < end && str.charAt(i) == '.') {
+        digitsEnd = skipDigits(str, i + 1, end, hex);
+        digits += digitsEnd - i - 1;
+        i = digitsEnd;
+    }
+    if (digits == 0) return false;
+
+    if (i < end && (str.charAt(i) | 0x20) == (hex ? 'p' : 'e')) {
+        ++i;
+        if (i < end && (str.charAt(i) == '+' || str.charAt(i) == '-')) ++i;
+        digitsEnd = skipDigits(str, i, end, false);
+        if (digitsEnd == i) return false;
+        i = digitsEnd;
+    } else if (hex) {
+        return false;
+    }
+    if (i < end && "fFdD".indexOf(str.charAt(i)) >= 0) ++i;
+    return i == end;
+}
 
-    for (String element : str.split(",")) {
-        ret.add(elementParser.apply(element));
+// Unlike integers, Double.valueOf only takes ASCII digits.
+private static int skipDigits(String str, int i, int end, boolean hex) {
+    while (i < end) {
+        char c = str.charAt(i);
+        int lower = c | 0x20;
+        if (!(c >= '0' && c <= '9') && !(hex && lower >= 'a' && lower <= 'f')) break;
+        ++i;
     }
+    return i;
+}
 
-    return ret;
+private static String tryParseString(String str) {
+    return "".equals(str) ? null : str;
 }
 
-private static <T extends Enum<T>> List<T> tryParseEnumList(Class<T> enumType, String str) {
+private static <T> List<T> tryParseList(Function<String, T> elementParser, String str) {
     if ("".equals(str)) return new ArrayList<>();
 
     List<T> ret = new ArrayList<>();
 
     for (String element : str.split(",")) {
-        ret.add(tryParseEnum(enumType, element));
+        ret.add(elementParser.apply(element));
     }
 
     return ret;
@@ -131,15 +228,86 @@ private static <T> String formatList(List<T> list) {
 
     return joiner.toString();
 }
+)";
+
+// Used by the <prop>_asArray() getters of --primitive-arrays. Elements are
+// found with indexOf and parsed in place, so only the array is allocated.
+constexpr const char* kJavaArrayParsers =
+    R"(
+// Number of elements of a list, as tryParseList splits it: String.split drops trailing empty
+// elements.
+private static int countElements(String str) {
+    int end = str.length();
+    while (end > 0 && str.charAt(end - 1) == ',') --end;
+    if (end == 0) return 0;
+    int count = 1;
+    for (int i = str.indexOf(','); i >= 0 && i < end; i = str.indexOf(',', i + 1)) ++count;
+    return count;
+}
 
-private static <T extends Enum<T>> String formatEnumList(List<T> list, Function<T, String> elementFormatter) {
-    StringJoiner joiner = new StringJoiner(",");
+private static int elementEnd(String str, int begin) {
+    int end = str.indexOf(',', begin);
+    return end < 0 ? str.length() : end;
+}
 
-    for (T element : list) {
-        joiner.add(element == null ? "" : elementFormatter.apply(element));
+private static boolean[] parseBooleanArray(String str, BitSet present) {
+    boolean[] ret = new boolean[countElements(str)];
+    if (present != null) present.clear();
+    for (int i = 0, begin = 0; i < ret.length; ++i) {
+        int end = elementEnd(str, begin);
+        Boolean value = tryParseBoolean(str, begin, end);
+        if (value != null) {
+            ret[i] = value;
+            if (present != null) present.set(i);
+        }
+        begin = end + 1;
     }
+    return ret;
+}
 
-    return joiner.toString();
+private static int[] parseIntArray(String str, BitSet present) {
+    int[] ret = new int[countElements(str)];
+    if (present != null) present.clear();
+    for (int i = 0, begin = 0; i < ret.length; ++i) {
+        int end = elementEnd(str, begin);
+        long scanned = scanDecimal(str, begin, end, Integer.MIN_VALUE, Integer.MAX_VALUE);
+        if (scanned <= 0) {
+            ret[i] = (int) decimalValue(str, begin, scanned);
+            if (present != null) present.set(i);
+        }
+        begin = end + 1;
+    }
+    return ret;
+}
+
+private static long[] parseLongArray(String str, BitSet present) {
+    long[] ret = new long[countElements(str)];
+    if (present != null) present.clear();
+    for (int i = 0, begin = 0; i < ret.length; ++i) {
+        int end = elementEnd(str, begin);
+        long scanned = scanDecimal(str, begin, end, Long.MIN_VALUE, Long.MAX_VALUE);
+        if (scanned <= 0) {
+            ret[i] = decimalValue(str, begin, scanned);
+            if (present != null) present.set(i);
+        }
+        begin = end + 1;
+    }
+    return ret;
+}
+
+// Only valid elements are copied out for Double.parseDouble.
+private static double[] parseDoubleArray(String str, BitSet present) {
+    double[] ret = new double[countElements(str)];
+    if (present != null) present.clear();
+    for (int i = 0, begin = 0; i < ret.length; ++i) {
+        int end = elementEnd(str, begin);
+        if (isDoubleString(str, begin, end)) {
+            ret[i] = Double.parseDouble(str.substring(begin, end));
+            if (present != null) present.set(i);
+        }
+        begin = end + 1;
+    }
+    return ret;
 }
 )";
 
@@ -153,8 +321,13 @@ std::string GetJavaClassName(const sysprop::Properties& props);
 std::string GetParsingExpression(const sysprop::Property& prop);
 std::string GetFormattingExpression(const sysprop::Property& prop);
 void WriteJavaAnnotation(CodeWriter& writer, sysprop::Scope scope);
+void WritePrimitiveGetters(CodeWriter& writer, const sysprop::Property& prop,
+                           sysprop::Scope class_scope);
+std::pair<std::string, std::string> GetJavaArrayParser(
+    const sysprop::Property& prop);
 bool GenerateJavaClass(const sysprop::Properties& props,
-                       std::string* java_result, std::string* err);
+                       const JavaGenOptions& options, std::string* java_result,
+                       std::string* err);
 
 std::string GetJavaEnumTypeName(const sysprop::Property& prop) {
   return ApiNameToIdentifier(prop.api_name()) + "_values";
@@ -204,17 +377,13 @@ std::string GetParsingExpression(const sysprop::Property& prop) {
     case sysprop::String:
       return "tryParseString(value)";
     case sysprop::Enum:
-      return "tryParseEnum(" + GetJavaEnumTypeName(prop) + ".class, value)";
-    case sysprop::EnumList:
-      return "tryParseEnumList(" + GetJavaEnumTypeName(prop) +
-             ".class, "
-             "value)";
+      return GetJavaEnumTypeName(prop) + ".tryParse(value)";
     default:
       break;
   }
 
-  // The remaining cases are lists for types other than Enum which share the
-  // same parsing function "tryParseList"
+  // The remaining cases are lists, which share the same parsing function
+  // "tryParseList"
   std::string element_parser;
 
   switch (prop.type()) {
@@ -233,6 +402,9 @@ std::string GetParsingExpression(const sysprop::Property& prop) {
     case sysprop::StringList:
       element_parser = "v -> tryParseString(v)";
       break;
+    case sysprop::EnumList:
+      element_parser = "v -> " + GetJavaEnumTypeName(prop) + ".tryParse(v)";
+      break;
     default:
       __builtin_unreachable();
   }
@@ -254,8 +426,7 @@ std::string GetFormattingExpression(const sysprop::Property& prop) {
   } else if (prop.type() == sysprop::Enum) {
     return "value.getPropValue()";
   } else if (prop.type() == sysprop::EnumList) {
-    return "formatEnumList(value, " + GetJavaEnumTypeName(prop) +
-           "::getPropValue)";
+    return GetJavaEnumTypeName(prop) + ".formatList(value)";
   } else if (IsListProp(prop)) {
     return "formatList(value)";
   } else {
@@ -287,8 +458,117 @@ void WriteJavaAnnotation(CodeWriter& writer, sysprop::Scope scope) {
   }
 }
 
+// Emits <prop>_asOptionalInt() and <prop>_orElse(int), and the same for Long
+// and Double properties, and <prop>_orElse(boolean) for Boolean properties.
+// Properties with a cache read their cached value; others are parsed straight
+// to the primitive.
+void WritePrimitiveGetters(CodeWriter& writer, const sysprop::Property& prop,
+                           sysprop::Scope class_scope) {
+  // |scan| is a statement which |check| and |parse| may depend on.
+  std::string primitive, optional_type, scan, check, parse;
+  switch (prop.type()) {
+    case sysprop::Boolean:
+      primitive = "boolean";
+      break;
+    case sysprop::Integer:
+      primitive = "int";
+      optional_type = "OptionalInt";
+      scan = "long scanned = scanDecimal(value, 0, value.length(), "
+             "Integer.MIN_VALUE, Integer.MAX_VALUE);\n";
+      check = "scanned <= 0";
+      parse = "(int) decimalValue(value, 0, scanned)";
+      break;
+    case sysprop::Long:
+      primitive = "long";
+      optional_type = "OptionalLong";
+      scan = "long scanned = scanDecimal(value, 0, value.length(), "
+             "Long.MIN_VALUE, Long.MAX_VALUE);\n";
+      check = "scanned <= 0";
+      parse = "decimalValue(value, 0, scanned)";
+      break;
+    case sysprop::Double:
+      primitive = "double";
+      optional_type = "OptionalDouble";
+      check = "isDoubleString(value)";
+      parse = "Double.parseDouble(value)";
+      break;
+    default:
+      return;
+  }
+
+  std::string prop_id = ApiNameToIdentifier(prop.api_name());
+  bool from_getter = prop.cache_policy() != sysprop::Uncached;
+
+  if (!optional_type.empty()) {
+    writer.Write("\n");
+    if (prop.scope() != class_scope) WriteJavaAnnotation(writer, prop.scope());
+    writer.Write("public static %s %s_asOptional%c%s() {\n",
+                 optional_type.c_str(), prop_id.c_str(),
+                 std::toupper(primitive[0]), primitive.c_str() + 1);
+    writer.Indent();
+    if (from_getter) {
+      writer.Write("Optional<%s> ret = %s();\n",
+                   GetJavaTypeName(prop).c_str(), prop_id.c_str());
+      writer.Write("return ret.isPresent() ? %s.of(ret.get()) : %s.empty();\n",
+                   optional_type.c_str(), optional_type.c_str());
+    } else {
+      writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                   prop.prop_name().c_str());
+      writer.Write("%s", scan.c_str());
+      writer.Write("return %s ? %s.of(%s) : %s.empty();\n", check.c_str(),
+                   optional_type.c_str(), parse.c_str(),
+                   optional_type.c_str());
+    }
+    writer.Dedent();
+    writer.Write("}\n");
+  }
+
+  writer.Write("\n");
+  if (prop.scope() != class_scope) WriteJavaAnnotation(writer, prop.scope());
+  writer.Write("public static %s %s_orElse(%s defaultValue) {\n",
+               primitive.c_str(), prop_id.c_str(), primitive.c_str());
+  writer.Indent();
+  if (from_getter) {
+    writer.Write("Optional<%s> ret = %s();\n", GetJavaTypeName(prop).c_str(),
+                 prop_id.c_str());
+    writer.Write("return ret.isPresent() ? ret.get() : defaultValue;\n");
+  } else if (prop.type() == sysprop::Boolean) {
+    // tryParseBoolean only returns the shared Boolean constants.
+    writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                 prop.prop_name().c_str());
+    writer.Write("Boolean ret = tryParseBoolean(value);\n");
+    writer.Write("return ret != null ? ret : defaultValue;\n");
+  } else {
+    writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                 prop.prop_name().c_str());
+    writer.Write("%s", scan.c_str());
+    writer.Write("return %s ? %s : defaultValue;\n", check.c_str(),
+                 parse.c_str());
+  }
+  writer.Dedent();
+  writer.Write("}\n");
+}
+
+// The parser of kJavaArrayParsers and the array type it returns, or empty
+// strings for properties other than numeric and boolean lists.
+std::pair<std::string, std::string> GetJavaArrayParser(
+    const sysprop::Property& prop) {
+  switch (prop.type()) {
+    case sysprop::BooleanList:
+      return {"parseBooleanArray", "boolean[]"};
+    case sysprop::IntegerList:
+      return {"parseIntArray", "int[]"};
+    case sysprop::LongList:
+      return {"parseLongArray", "long[]"};
+    case sysprop::DoubleList:
+      return {"parseDoubleArray", "double[]"};
+    default:
+      return {};
+  }
+}
+
 bool GenerateJavaClass(const sysprop::Properties& props,
-                       std::string* java_result,
+                       const JavaGenOptions& options, std::string* java_result,
                        [[maybe_unused]] std::string* err) {
   sysprop::Scope classScope = sysprop::Internal;
 
@@ -311,6 +591,16 @@ bool GenerateJavaClass(const sysprop::Properties& props,
   writer.Indent();
   writer.Write("private %s () {}\n\n", class_name.c_str());
   writer.Write("%s", kJavaParsersAndFormatters);
+  if (HasCachePolicy(props, sysprop::Serial)) {
+    writer.Write("%s", kJavaCachedValue);
+  }
+  if (options.primitive_arrays &&
+      std::any_of(props.prop().begin(), props.prop().end(),
+                  [](const auto& prop) {
+                    return !GetJavaArrayParser(prop).first.empty();
+                  })) {
+    writer.Write("%s", kJavaArrayParsers);
+  }
 
   for (int i = 0; i < props.prop_size(); ++i) {
     writer.Write("\n");
@@ -352,31 +642,143 @@ bool GenerateJavaClass(const sysprop::Properties& props,
       writer.Write("return propValue;\n");
       writer.Dedent();
       writer.Write("}\n");
+
+      // A switch on the exact values, which is all setters write. Other
+      // spellings fall back to the names of the constants, exactly as
+      // Enum.valueOf(str.toUpperCase(Locale.US)) matched them.
+      writer.Write("private static %s tryParse(String str) {\n",
+                   GetJavaEnumTypeName(prop).c_str());
+      writer.Indent();
+      writer.Write("switch (str) {\n");
+      writer.Indent();
+      for (const std::string& name : values) {
+        writer.Write("case \"%s\": return %s;\n", name.c_str(),
+                     ToUpper(name).c_str());
+      }
+      writer.Write("default: break;\n");
+      writer.Dedent();
+      writer.Write("}\n");
+      writer.Write("switch (str.toUpperCase(Locale.US)) {\n");
+      writer.Indent();
+      for (const std::string& name : values) {
+        writer.Write("case \"%s\": return %s;\n", ToUpper(name).c_str(),
+                     ToUpper(name).c_str());
+      }
+      writer.Write("default: return null;\n");
+      writer.Dedent();
+      writer.Write("}\n");
+      writer.Dedent();
+      writer.Write("}\n");
+
+      if (prop.type() == sysprop::EnumList &&
+          prop.access() != sysprop::Readonly) {
+        writer.Write("private static String formatList(List<%s> list) {\n",
+                     GetJavaEnumTypeName(prop).c_str());
+        writer.Indent();
+        writer.Write("StringJoiner joiner = new StringJoiner(\",\");\n");
+        writer.Write("for (%s element : list) {\n",
+                     GetJavaEnumTypeName(prop).c_str());
+        writer.Indent();
+        writer.Write(
+            "joiner.add(element == null ? \"\" : element.propValue);\n");
+        writer.Dedent();
+        writer.Write("}\n");
+        writer.Write("return joiner.toString();\n");
+        writer.Dedent();
+        writer.Write("}\n");
+      }
       writer.Dedent();
       writer.Write("}\n\n");
     }
 
+    std::string result_type = prop_type;
+    std::string result = GetParsingExpression(prop);
+    if (!IsListProp(prop)) {
+      result_type = "Optional<" + prop_type + ">";
+      result = "Optional.ofNullable(" + result + ")";
+    } else if (prop.cache_policy() != sysprop::Uncached) {
+      // Cached lists are shared by all callers.
+      result = "java.util.Collections.unmodifiableList(" + result + ")";
+    }
+
+    switch (prop.cache_policy()) {
+      case sysprop::Boot:
+        writer.Write("private static volatile %s %s_value;\n\n",
+                     result_type.c_str(), prop_id.c_str());
+        break;
+      default:
+        if (prop.cache_policy() == sysprop::Serial) {
+          writer.Write(
+              "private static volatile CachedValue<%s> %s_cache;\n\n",
+              result_type.c_str(), prop_id.c_str());
+        }
+        break;
+    }
+
     if (prop.scope() != classScope) {
       WriteJavaAnnotation(writer, prop.scope());
     }
 
-    if (IsListProp(prop)) {
-      writer.Write("public static %s %s() {\n", prop_type.c_str(),
-                   prop_id.c_str());
-      writer.Indent();
-      writer.Write("String value = SystemProperties.get(\"%s\");\n",
-                   prop.prop_name().c_str());
-      writer.Write("return %s;\n", GetParsingExpression(prop).c_str());
-      writer.Dedent();
-      writer.Write("}\n");
-    } else {
-      writer.Write("public static Optional<%s> %s() {\n", prop_type.c_str(),
-                   prop_id.c_str());
+    writer.Write("public static %s %s() {\n", result_type.c_str(),
+                 prop_id.c_str());
+    writer.Indent();
+    switch (prop.cache_policy()) {
+      case sysprop::Boot:
+        // The value never changes once the property has been set.
+        writer.Write("%s ret = %s_value;\n", result_type.c_str(),
+                     prop_id.c_str());
+        writer.Write("if (ret != null) return ret;\n");
+        writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                     prop.prop_name().c_str());
+        writer.Write("ret = %s;\n", result.c_str());
+        writer.Write("if (!\"\".equals(value)) %s_value = ret;\n",
+                     prop_id.c_str());
+        writer.Write("return ret;\n");
+        break;
+      default:
+        if (prop.cache_policy() != sysprop::Serial) {
+          writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                       prop.prop_name().c_str());
+          writer.Write("return %s;\n", result.c_str());
+          break;
+        }
+        // Java can't see the serial of a property, so the value read is
+        // compared instead. That still saves parsing it again.
+        writer.Write("String value = SystemProperties.get(\"%s\");\n",
+                     prop.prop_name().c_str());
+        writer.Write("CachedValue<%s> cache = %s_cache;\n",
+                     result_type.c_str(), prop_id.c_str());
+        writer.Write(
+            "if (cache == null || !cache.propValue.equals(value)) {\n");
+        writer.Indent();
+        writer.Write("cache = new CachedValue<>(value, %s);\n", result.c_str());
+        writer.Write("%s_cache = cache;\n", prop_id.c_str());
+        writer.Dedent();
+        writer.Write("}\n");
+        writer.Write("return cache.value;\n");
+        break;
+    }
+    writer.Dedent();
+    writer.Write("}\n");
+
+    if (options.primitive_getters) {
+      WritePrimitiveGetters(writer, prop, classScope);
+    }
+
+    auto [array_parser, array_type] = GetJavaArrayParser(prop);
+    if (options.primitive_arrays && !array_parser.empty()) {
+      // Elements which are empty or don't parse are left 0 or false, and
+      // cleared in |present|.
+      writer.Write("\n");
+      if (prop.scope() != classScope) {
+        WriteJavaAnnotation(writer, prop.scope());
+      }
+      writer.Write(
+          "public static %s %s_asArray(BitSet present) {\n",
+          array_type.c_str(), prop_id.c_str());
       writer.Indent();
-      writer.Write("String value = SystemProperties.get(\"%s\");\n",
-                   prop.prop_name().c_str());
-      writer.Write("return Optional.ofNullable(%s);\n",
-                   GetParsingExpression(prop).c_str());
+      writer.Write("return %s(SystemProperties.get(\"%s\"), present);\n",
+                   array_parser.c_str(), prop.prop_name().c_str());
       writer.Dedent();
       writer.Write("}\n");
     }
@@ -407,7 +809,8 @@ bool GenerateJavaClass(const sysprop::Properties& props,
 }  // namespace
 
 bool GenerateJavaLibrary(const std::string& input_file_path,
-                         const std::string& java_output_dir, std::string* err) {
+                         const std::string& java_output_dir,
+                         const JavaGenOptions& options, std::string* err) {
   sysprop::Properties props;
 
   if (!ParseProps(input_file_path, &props, err)) {
@@ -416,7 +819,7 @@ bool GenerateJavaLibrary(const std::string& input_file_path,
 
   std::string java_result;
 
-  if (!GenerateJavaClass(props, &java_result, err)) {
+  if (!GenerateJavaClass(props, options, &java_result, err)) {
     return false;
   }
 
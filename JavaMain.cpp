@@ -30,10 +30,13 @@ namespace {
 struct Arguments {
   std::string input_file_path;
   std::string java_output_dir;
+  JavaGenOptions options;
 };
 
 [[noreturn]] void PrintUsage(const char* exe_name) {
-  std::printf("Usage: %s [--java-output-dir dir] sysprop_file\n", exe_name);
+  std::printf("Usage: %s [--java-output-dir dir] "
+              "[--primitive-getters] [--primitive-arrays] sysprop_file\n",
+              exe_name);
   std::exit(EXIT_FAILURE);
 }
 
@@ -41,6 +44,9 @@ bool ParseArgs(int argc, char* argv[], Arguments* args, std::string* err) {
   for (;;) {
     static struct option long_options[] = {
         {"java-output-dir", required_argument, 0, 'j'},
+        {"primitive-getters", no_argument, 0, 'P'},
+        {"primitive-arrays", no_argument, 0, 'a'},
+        {0, 0, 0, 0},
     };
 
     int opt = getopt_long_only(argc, argv, "", long_options, nullptr);
@@ -50,6 +56,12 @@ bool ParseArgs(int argc, char* argv[], Arguments* args, std::string* err) {
       case 'j':
         args->java_output_dir = optarg;
         break;
+      case 'P':
+        args->options.primitive_getters = true;
+        break;
+      case 'a':
+        args->options.primitive_arrays = true;
+        break;
       default:
         PrintUsage(argv[0]);
     }
@@ -81,7 +93,8 @@ int main(int argc, char* argv[]) {
     PrintUsage(argv[0]);
   }
 
-  if (!GenerateJavaLibrary(args.input_file_path, args.java_output_dir, &err)) {
+  if (!GenerateJavaLibrary(args.input_file_path, args.java_output_dir,
+                           args.options, &err)) {
     LOG(FATAL) << "Error during generating java sysprop from "
                << args.input_file_path << ": " << err;
   }
@@ -26,6 +26,8 @@ inline static constexpr const char* kGeneratedFileFooterComments =
 std::string ApiNameToIdentifier(const std::string& name);
 bool CreateDirectories(const std::string& path);
 std::string GetModuleName(const sysprop::Properties& props);
+bool HasCachePolicy(const sysprop::Properties& props,
+                    sysprop::CachePolicy policy);
 bool IsDirectory(const std::string& path);
 bool IsListProp(const sysprop::Property& prop);
 bool ParseProps(const std::string& file_path, sysprop::Properties* props,
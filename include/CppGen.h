@@ -19,10 +19,61 @@
 
 #include <string>
 
+struct CppGenOptions {
+  // Getters keep their last parsed value and reuse it while the serial of the
+  // property is unchanged, as for properties with cache_policy: Serial.
+  bool cache_values = false;
+  // Emit Prewarm(), which resolves the prop_info of every property at once.
+  bool prewarm = false;
+  // Emit a <Module>Snapshot of every property visible at the scope of each
+  // header, along with ReadSnapshot() and IsStale().
+  bool snapshot = false;
+  // Link against libsysprop_runtime instead of embedding parsers and
+  // formatters in the generated source.
+  bool runtime = false;
+  // Describe the properties with a constexpr table and make every accessor a
+  // call into the runtime. Requires runtime.
+  bool table = false;
+  // Emit <prop>_WaitFor(), which blocks until a predicate holds for the value
+  // of the property.
+  bool wait_for = false;
+  // Emit a Watcher, which calls back with the new value of a property after
+  // it changes. All watchers share one thread per process, so this requires
+  // runtime.
+  bool watcher = false;
+  // Emit <prop>_Inline() for lists of non-"ro." properties, which returns the
+  // list in an InlineList that never allocates.
+  bool inline_lists = false;
+  // Emit getters for strings and lists which take a std::pmr::memory_resource
+  // and return pmr containers allocated from it. They parse the current value
+  // on every call, whatever the cache_policy of the property.
+  bool pmr = false;
+  // Give enums a std::uint8_t underlying type, and emit <prop>_Set() for
+  // EnumList properties and <prop>_Packed() for BooleanList properties, which
+  // return bitsets instead of vectors.
+  bool compact = false;
+  // Setters skip the property service when the property already has the
+  // value, and setters of cached properties store what they wrote in the
+  // cache of the getter, so the next read doesn't parse it again.
+  bool elide_writes = false;
+  // Emit <prop>_SetAsync(), which queues the value for a writer thread and
+  // returns at once, and Flush(). The writer thread is shared by the whole
+  // process, so this requires runtime.
+  bool async_writes = false;
+  // Emit a constexpr handle of type Prop<T, Tag> for every property, along
+  // with Get() and Set() over handles and all_props, a tuple of all handles.
+  bool typed_handles = false;
+  // Also generate <name>_c.h, which declares extern "C" accessors. They parse
+  // values like the C++ ones, but take buffers of the caller and return a
+  // sysprop_status_t, so they can be called from C and through FFI.
+  bool c_api = false;
+};
+
 bool GenerateCppFiles(const std::string& input_file_path,
                       const std::string& header_dir,
                       const std::string& system_header_dir,
                       const std::string& source_output_dir,
-                      const std::string& include_name, std::string* err);
+                      const std::string& include_name,
+                      const CppGenOptions& options, std::string* err);
 
 #endif  // SYSTEM_TOOLS_SYSPROP_CPPGEN_H_
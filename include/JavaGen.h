@@ -19,7 +19,19 @@
 
 #include <string>
 
+struct JavaGenOptions {
+  // Emit <prop>_asOptionalInt() and <prop>_orElse(int), and the same for Long
+  // and Double properties, which return primitives instead of boxed values,
+  // and <prop>_orElse(boolean) for Boolean properties.
+  bool primitive_getters = false;
+  // Emit <prop>_asArray(BitSet present) for BooleanList, IntegerList,
+  // LongList and DoubleList properties, which returns a primitive array and
+  // sets the bits of the elements which are present.
+  bool primitive_arrays = false;
+};
+
 bool GenerateJavaLibrary(const std::string& input_file_path,
-                         const std::string& java_output_dir, std::string* err);
+                         const std::string& java_output_dir,
+                         const JavaGenOptions& options, std::string* err);
 
 #endif  // SYSTEM_TOOLS_SYSPROP_JAVAGEN_H_
@@ -0,0 +1,688 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sysprop/Runtime.h"
+
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <log/log.h>
+
+namespace android::sysprop::runtime {
+
+namespace {
+
+// Returns the index of |str| among the names of |table|, with a binary
+// search through table.by_name.
+std::optional<std::size_t> ParseEnum(const EnumTable& table,
+                                     std::string_view str) {
+  const std::uint16_t* end = table.by_name + table.size;
+  const std::uint16_t* found = std::lower_bound(
+      table.by_name, end, str, [&](std::uint16_t index, std::string_view str) {
+        return std::string_view(table.names[index]) < str;
+      });
+  if (found != end && str == table.names[*found]) return *found;
+  return std::nullopt;
+}
+
+// Appends the name of enumerator |index| of |prop|, aborting if there is
+// none.
+void AppendEnumName(ValueBuffer& buf, const PropDescriptor& prop,
+                    std::size_t index) {
+  if (index < prop.enum_table->size) {
+    buf.Append(prop.enum_table->names[index]);
+    return;
+  }
+  LOG_ALWAYS_FATAL("Invalid value %zu for property %s", index, prop.name);
+}
+
+void AppendEnumNames(ValueBuffer& buf, const PropDescriptor& prop,
+                     std::size_t size,
+                     std::optional<std::size_t> (*index_at)(const void* list,
+                                                            std::size_t i),
+                     const void* list) {
+  for (std::size_t i = 0; i < size; ++i) {
+    if (i > 0) buf.Append(",");
+    auto index = index_at(list, i);
+    if (index) AppendEnumName(buf, prop, *index);
+  }
+}
+
+// Calls |read| with the current value of |prop| unless it doesn't exist.
+template <typename Read>
+void ReadRawValue(const PropDescriptor& prop, Read read) {
+  auto pi = prop.handle->Find();
+  if (pi == nullptr) return;
+  __system_property_read_callback(
+      pi,
+      [](void* cookie, const char*, const char* value, std::uint32_t) {
+        (*static_cast<Read*>(cookie))(value);
+      },
+      &read);
+}
+
+// Sets |prop| to the value formatted into |buf|. Fails with errno set to
+// EROFS for Readonly properties, or to E2BIG if the value is too long.
+bool WriteRawValue(const PropDescriptor& prop, ValueBuffer& buf) {
+  if (prop.access == PropAccess::kReadonly) {
+    errno = EROFS;
+    return false;
+  }
+  if (buf.overflowed()) {
+    errno = E2BIG;
+    return false;
+  }
+  if (prop.elide_writes) {
+    return SetRawValueIfChanged(*prop.handle, prop.name, buf.c_str(), nullptr);
+  }
+  return __system_property_set(prop.name, buf.c_str()) == 0;
+}
+
+// Same as WriteRawValue, through |slot|.
+WriteToken QueueRawValue(const PropDescriptor& prop, AsyncWriteSlot& slot,
+                         ValueBuffer& buf) {
+  if (prop.access == PropAccess::kReadonly) {
+    errno = EROFS;
+    return WriteToken();
+  }
+  if (buf.overflowed()) {
+    errno = E2BIG;
+    return WriteToken();
+  }
+  return slot.Queue(buf.c_str());
+}
+
+template <typename T>
+T ReadBuiltinValue(const PropDescriptor& prop) {
+  return GetProp<T>(*prop.handle);
+}
+
+template <typename T>
+bool WriteBuiltinValue(const PropDescriptor& prop, const T& value) {
+  ValueBuffer buf(prop.name, prop.integer_as_bool);
+  FormatValue(buf, value);
+  return WriteRawValue(prop, buf);
+}
+
+// Runs the callbacks of every watch on one detached thread. It's leaked
+// along with the thread, so watches may outlive static destructors.
+class WatcherThread {
+ public:
+  static WatcherThread& Get() {
+    static WatcherThread* instance = new WatcherThread;
+    return *instance;
+  }
+
+  std::uint64_t Add(PropHandle& handle, std::function<void()> on_change) {
+    std::lock_guard lock(mutex_);
+    // Take the current serial as the baseline, so only later changes are
+    // reported.
+    const prop_info* pi = handle.Find();
+    std::uint32_t serial = pi ? __system_property_serial(pi) : 0;
+    std::uint64_t id = next_id_++;
+    watches_.emplace(id, Watch{&handle, pi, serial, std::move(on_change)});
+    if (!started_) {
+      started_ = true;
+      std::thread([this] { Run(); }).detach();
+    }
+    return id;
+  }
+
+  void Remove(std::uint64_t id) {
+    std::unique_lock lock(mutex_);
+    if (std::this_thread::get_id() == thread_id_ && running_id_ == id) {
+      // Called from the running callback, which is still using the watch.
+      watches_.at(id).removed = true;
+      return;
+    }
+    callback_done_.wait(lock, [&] { return running_id_ != id; });
+    watches_.erase(id);
+  }
+
+ private:
+  struct Watch {
+    PropHandle* handle;
+    const prop_info* pi;
+    std::uint32_t serial;
+    std::function<void()> on_change;
+    bool removed = false;
+  };
+
+  void Run() {
+    {
+      std::lock_guard lock(mutex_);
+      thread_id_ = std::this_thread::get_id();
+    }
+    std::vector<std::uint64_t> changed;
+    for (;;) {
+      // Read the area serial first, so a change made while the watches are
+      // being checked wakes the loop up again.
+      std::uint32_t area_serial = __system_property_area_serial();
+      changed.clear();
+      {
+        std::lock_guard lock(mutex_);
+        for (auto& [id, watch] : watches_) {
+          const prop_info* pi = watch.pi ? watch.pi : watch.handle->Find();
+          if (pi == nullptr) continue;
+          std::uint32_t serial = __system_property_serial(pi);
+          if (pi != watch.pi || serial != watch.serial) {
+            watch.pi = pi;
+            watch.serial = serial;
+            changed.push_back(id);
+          }
+        }
+      }
+      for (std::uint64_t id : changed) {
+        Watch* watch;
+        {
+          std::lock_guard lock(mutex_);
+          auto it = watches_.find(id);
+          if (it == watches_.end()) continue;
+          watch = &it->second;
+          running_id_ = id;
+        }
+        // Map nodes are stable, and Remove() waits for running_id_ to move
+        // on before erasing this one.
+        watch->on_change();
+        {
+          std::lock_guard lock(mutex_);
+          running_id_ = 0;
+          if (watch->removed) watches_.erase(id);
+        }
+        callback_done_.notify_all();
+      }
+      __system_property_wait(nullptr, area_serial, &area_serial, nullptr);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable callback_done_;
+  std::map<std::uint64_t, Watch> watches_;
+  std::uint64_t next_id_ = 1;
+  std::uint64_t running_id_ = 0;
+  bool started_ = false;
+  std::thread::id thread_id_;
+};
+
+}  // namespace
+
+// Sends the values queued in AsyncWriteSlots to the property service, on one
+// thread per process. Setters push their slot onto a lock-free stack, which
+// the thread takes over in one exchange and writes in the order the slots
+// were queued. Only a setter which finds the stack empty takes mutex_, to
+// wake the thread up.
+class AsyncWriter {
+ public:
+  static AsyncWriter& Get() {
+    static AsyncWriter* instance = new AsyncWriter;
+    return *instance;
+  }
+
+  // Called with the mutex of |slot| held, when it isn't queued yet.
+  void Push(AsyncWriteSlot* slot) {
+    AsyncWriteSlot* head = head_.load(std::memory_order_relaxed);
+    do {
+      slot->next_ = head;
+    } while (!head_.compare_exchange_weak(head, slot, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    if (head != nullptr) return;
+
+    std::lock_guard lock(mutex_);
+    if (!started_) {
+      started_ = true;
+      std::thread([this] { Run(); }).detach();
+    }
+    work_.notify_one();
+  }
+
+  void Wait(const AsyncWriteSlot& slot, std::uint64_t seq) {
+    std::unique_lock lock(mutex_);
+    written_.wait(lock, [&] {
+      return slot.written_seq_.load(std::memory_order_acquire) >= seq;
+    });
+  }
+
+  void Flush() {
+    std::unique_lock lock(mutex_);
+    if (!started_) return;
+    // Slots pushed before this call are either in the batch being written,
+    // or taken by the next one.
+    std::uint64_t batch = started_batches_ + 1;
+    flush_requested_ = true;
+    work_.notify_one();
+    written_.wait(lock, [&] { return finished_batches_ >= batch; });
+  }
+
+ private:
+  void Run() {
+    std::string value;
+    for (;;) {
+      {
+        std::unique_lock lock(mutex_);
+        work_.wait(lock, [this] {
+          return flush_requested_ ||
+                 head_.load(std::memory_order_relaxed) != nullptr;
+        });
+        flush_requested_ = false;
+        ++started_batches_;
+      }
+
+      // The stack holds the slots in reverse order.
+      AsyncWriteSlot* slot = nullptr;
+      AsyncWriteSlot* head = head_.exchange(nullptr, std::memory_order_acquire);
+      while (head != nullptr) {
+        AsyncWriteSlot* next = head->next_;
+        head->next_ = slot;
+        slot = head;
+        head = next;
+      }
+
+      while (slot != nullptr) {
+        // A setter may queue the slot again as soon as queued_ is cleared.
+        AsyncWriteSlot* next = slot->next_;
+        std::uint64_t seq;
+        {
+          std::lock_guard lock(slot->mutex_);
+          value = slot->value_;
+          seq = slot->seq_;
+          slot->queued_ = false;
+        }
+        bool ok = __system_property_set(slot->name_, value.c_str()) == 0;
+        slot->written_ok_.store(ok, std::memory_order_relaxed);
+        slot->written_seq_.store(seq, std::memory_order_release);
+        slot = next;
+      }
+
+      {
+        std::lock_guard lock(mutex_);
+        ++finished_batches_;
+      }
+      written_.notify_all();
+    }
+  }
+
+  std::atomic<AsyncWriteSlot*> head_{nullptr};
+  std::mutex mutex_;
+  std::condition_variable work_;
+  std::condition_variable written_;
+  std::uint64_t started_batches_ = 0;
+  std::uint64_t finished_batches_ = 0;
+  bool flush_requested_ = false;
+  bool started_ = false;
+};
+
+#include "shared/ParseImpl.inc"
+
+#include "shared/PropHandleImpl.inc"
+
+#include "shared/InlineListImpl.inc"
+
+#include "shared/SetIfChangedImpl.inc"
+
+#include "shared/WaitForImpl.inc"
+
+std::uint64_t AddWatch(PropHandle& handle, std::function<void()> on_change) {
+  return WatcherThread::Get().Add(handle, std::move(on_change));
+}
+
+void RemoveWatch(std::uint64_t id) { WatcherThread::Get().Remove(id); }
+
+WriteToken AsyncWriteSlot::Queue(const char* value) {
+  std::lock_guard lock(mutex_);
+  value_ = value;
+  std::uint64_t seq = ++seq_;
+  if (!queued_) {
+    queued_ = true;
+    AsyncWriter::Get().Push(this);
+  }
+  return WriteToken(this, seq);
+}
+
+bool WriteToken::done() const {
+  return slot_ == nullptr ||
+         slot_->written_seq_.load(std::memory_order_acquire) >= seq_;
+}
+
+bool WriteToken::Wait() const {
+  if (slot_ == nullptr) return false;
+  if (!done()) AsyncWriter::Get().Wait(*slot_, seq_);
+  return slot_->written_ok_.load(std::memory_order_relaxed);
+}
+
+void FlushAsyncWrites() { AsyncWriter::Get().Flush(); }
+
+std::optional<std::size_t> ParseEnumName(const PropDescriptor& prop,
+                                         std::string_view name) {
+  return ParseEnum(*prop.enum_table, name);
+}
+
+std::optional<std::size_t> ReadEnum(const PropDescriptor& prop) {
+  std::optional<std::size_t> ret;
+  ReadRawValue(prop, [&](std::string_view value) {
+    ret = ParseEnum(*prop.enum_table, value);
+  });
+  return ret;
+}
+
+void ReadEnumList(const PropDescriptor& prop,
+                  void (*assign)(void* list,
+                                 const std::optional<std::size_t>* indices,
+                                 std::size_t size),
+                  void* list) {
+  ReadRawValue(prop, [&](std::string_view value) {
+    // Values of non-"ro." properties are shorter than PROP_VALUE_MAX, so they
+    // have at most that many elements. Longer "ro." ones go to the heap.
+    constexpr std::size_t kMaxElements = PROP_VALUE_MAX;
+
+    std::size_t size = std::count(value.begin(), value.end(), ',') + 1;
+    std::optional<std::size_t> stack_indices[kMaxElements];
+    std::vector<std::optional<std::size_t>> heap_indices;
+    std::optional<std::size_t>* indices = stack_indices;
+    if (size > kMaxElements) {
+      heap_indices.resize(size);
+      indices = heap_indices.data();
+    }
+
+    for (std::size_t i = 0;; ++i) {
+      std::size_t found = value.find(',');
+      indices[i] = ParseEnum(*prop.enum_table, value.substr(0, found));
+      if (found == std::string_view::npos) break;
+      value.remove_prefix(found + 1);
+    }
+    assign(list, indices, size);
+  });
+}
+
+bool WriteEnum(const PropDescriptor& prop, std::optional<std::size_t> index) {
+  ValueBuffer buf(prop.name, prop.integer_as_bool);
+  if (index) AppendEnumName(buf, prop, *index);
+  return WriteRawValue(prop, buf);
+}
+
+bool WriteEnumList(const PropDescriptor& prop, std::size_t size,
+                   std::optional<std::size_t> (*index_at)(const void* list,
+                                                          std::size_t i),
+                   const void* list) {
+  ValueBuffer buf(prop.name, prop.integer_as_bool);
+  AppendEnumNames(buf, prop, size, index_at, list);
+  return WriteRawValue(prop, buf);
+}
+
+WriteToken WriteEnumAsync(const PropDescriptor& prop, AsyncWriteSlot& slot,
+                          std::optional<std::size_t> index) {
+  ValueBuffer buf(prop.name, prop.integer_as_bool);
+  if (index) AppendEnumName(buf, prop, *index);
+  return QueueRawValue(prop, slot, buf);
+}
+
+WriteToken WriteEnumListAsync(
+    const PropDescriptor& prop, AsyncWriteSlot& slot, std::size_t size,
+    std::optional<std::size_t> (*index_at)(const void* list, std::size_t i),
+    const void* list) {
+  ValueBuffer buf(prop.name, prop.integer_as_bool);
+  AppendEnumNames(buf, prop, size, index_at, list);
+  return QueueRawValue(prop, slot, buf);
+}
+
+template <>
+std::optional<bool> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::optional<bool>>(prop);
+}
+
+template <>
+std::optional<std::int32_t> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::optional<std::int32_t>>(prop);
+}
+
+template <>
+std::optional<std::int64_t> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::optional<std::int64_t>>(prop);
+}
+
+template <>
+std::optional<double> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::optional<double>>(prop);
+}
+
+template <>
+std::optional<std::string> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::optional<std::string>>(prop);
+}
+
+template <>
+std::vector<std::optional<bool>> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::vector<std::optional<bool>>>(prop);
+}
+
+template <>
+std::vector<std::optional<std::int32_t>> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::vector<std::optional<std::int32_t>>>(prop);
+}
+
+template <>
+std::vector<std::optional<std::int64_t>> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::vector<std::optional<std::int64_t>>>(prop);
+}
+
+template <>
+std::vector<std::optional<double>> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::vector<std::optional<double>>>(prop);
+}
+
+template <>
+std::vector<std::optional<std::string>> ReadValue(const PropDescriptor& prop) {
+  return ReadBuiltinValue<std::vector<std::optional<std::string>>>(prop);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop, const std::optional<bool>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::int32_t>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::int64_t>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<double>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::string>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<bool>>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::int32_t>>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::int64_t>>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<double>>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::string>>& value) {
+  return WriteBuiltinValue(prop, value);
+}
+
+template std::vector<std::optional<bool>> DoParseList(std::string_view);
+template std::vector<std::optional<std::int32_t>> DoParseList(
+    std::string_view);
+template std::vector<std::optional<std::int64_t>> DoParseList(
+    std::string_view);
+template std::vector<std::optional<double>> DoParseList(std::string_view);
+template std::vector<std::optional<std::string>> DoParseList(std::string_view);
+
+template void FormatValue(ValueBuffer&,
+                          const std::vector<std::optional<bool>>&);
+template void FormatValue(ValueBuffer&,
+                          const std::vector<std::optional<std::int32_t>>&);
+template void FormatValue(ValueBuffer&,
+                          const std::vector<std::optional<std::int64_t>>&);
+template void FormatValue(ValueBuffer&,
+                          const std::vector<std::optional<double>>&);
+template void FormatValue(ValueBuffer&,
+                          const std::vector<std::optional<std::string>>&);
+
+template std::optional<bool> GetProp(PropHandle&);
+template std::optional<std::int32_t> GetProp(PropHandle&);
+template std::optional<std::int64_t> GetProp(PropHandle&);
+template std::optional<double> GetProp(PropHandle&);
+template std::optional<std::string> GetProp(PropHandle&);
+template std::vector<std::optional<bool>> GetProp(PropHandle&);
+template std::vector<std::optional<std::int32_t>> GetProp(PropHandle&);
+template std::vector<std::optional<std::int64_t>> GetProp(PropHandle&);
+template std::vector<std::optional<double>> GetProp(PropHandle&);
+template std::vector<std::optional<std::string>> GetProp(PropHandle&);
+template std::optional<std::pmr::string> GetProp(PropHandle&,
+                                                  std::pmr::memory_resource&);
+template std::pmr::vector<std::optional<bool>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+template std::pmr::vector<std::optional<std::int32_t>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+template std::pmr::vector<std::optional<std::int64_t>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+template std::pmr::vector<std::optional<double>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+template std::pmr::vector<std::optional<std::pmr::string>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+
+template bool SetProp(const char*, const std::optional<bool>&, bool);
+template bool SetProp(const char*, const std::optional<std::int32_t>&, bool);
+template bool SetProp(const char*, const std::optional<std::int64_t>&, bool);
+template bool SetProp(const char*, const std::optional<double>&, bool);
+template bool SetProp(const char*, const std::optional<std::string>&, bool);
+template bool SetProp(const char*, const std::vector<std::optional<bool>>&,
+                      bool);
+template bool SetProp(const char*,
+                      const std::vector<std::optional<std::int32_t>>&, bool);
+template bool SetProp(const char*,
+                      const std::vector<std::optional<std::int64_t>>&, bool);
+template bool SetProp(const char*, const std::vector<std::optional<double>>&,
+                      bool);
+template bool SetProp(const char*,
+                      const std::vector<std::optional<std::string>>&, bool);
+
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::optional<bool>&, bool,
+                              PropCache<std::optional<bool>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::optional<std::int32_t>&, bool,
+                              PropCache<std::optional<std::int32_t>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::optional<std::int64_t>&, bool,
+                              PropCache<std::optional<std::int64_t>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::optional<double>&, bool,
+                              PropCache<std::optional<double>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::optional<std::string>&, bool,
+                              PropCache<std::optional<std::string>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::vector<std::optional<bool>>&, bool,
+                              PropCache<std::vector<std::optional<bool>>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::vector<std::optional<std::int32_t>>&, bool,
+                              PropCache<std::vector<std::optional<std::int32_t>>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::vector<std::optional<std::int64_t>>&, bool,
+                              PropCache<std::vector<std::optional<std::int64_t>>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::vector<std::optional<double>>&, bool,
+                              PropCache<std::vector<std::optional<double>>>*);
+template bool SetPropIfChanged(PropHandle&, const char*,
+                              const std::vector<std::optional<std::string>>&, bool,
+                              PropCache<std::vector<std::optional<std::string>>>*);
+
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::optional<bool>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::optional<std::int32_t>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::optional<std::int64_t>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::optional<double>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::optional<std::string>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::vector<std::optional<bool>>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::vector<std::optional<std::int32_t>>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::vector<std::optional<std::int64_t>>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::vector<std::optional<double>>&,
+                                bool);
+template WriteToken SetPropAsync(AsyncWriteSlot&, const std::vector<std::optional<std::string>>&,
+                                bool);
+
+template class PropCache<std::optional<bool>>;
+template class PropCache<std::optional<std::int32_t>>;
+template class PropCache<std::optional<std::int64_t>>;
+template class PropCache<std::optional<double>>;
+template class PropCache<std::optional<std::string>>;
+template class PropCache<std::vector<std::optional<bool>>>;
+template class PropCache<std::vector<std::optional<std::int32_t>>>;
+template class PropCache<std::vector<std::optional<std::int64_t>>>;
+template class PropCache<std::vector<std::optional<double>>>;
+template class PropCache<std::vector<std::optional<std::string>>>;
+
+template class BootValue<std::optional<bool>>;
+template class BootValue<std::optional<std::int32_t>>;
+template class BootValue<std::optional<std::int64_t>>;
+template class BootValue<std::optional<double>>;
+template class BootValue<std::optional<std::string>>;
+template class BootValue<std::vector<std::optional<bool>>>;
+template class BootValue<std::vector<std::optional<std::int32_t>>>;
+template class BootValue<std::vector<std::optional<std::int64_t>>>;
+template class BootValue<std::vector<std::optional<double>>>;
+template class BootValue<std::vector<std::optional<std::string>>>;
+
+}  // namespace android::sysprop::runtime
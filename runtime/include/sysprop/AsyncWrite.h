@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_TOOLS_SYSPROP_ASYNC_WRITE_H_
+#define SYSTEM_TOOLS_SYSPROP_ASYNC_WRITE_H_
+
+#include <cstdint>
+
+// The part of libsysprop_runtime which headers generated with --async-writes
+// expose to their users.
+
+namespace android::sysprop::runtime {
+
+class AsyncWriteSlot;
+
+// Completion of a write queued by <prop>_SetAsync(). A value which is
+// replaced by a later one before the writer thread gets to it is never sent
+// to the property service, so its token completes with the later write.
+class WriteToken {
+ public:
+  // A write which failed before it could be queued.
+  WriteToken() = default;
+
+  WriteToken(const AsyncWriteSlot* slot, std::uint64_t seq)
+      : slot_(slot), seq_(seq) {}
+
+  bool done() const;
+
+  // Blocks until done(), then returns whether the latest write of the
+  // property succeeded.
+  bool Wait() const;
+
+ private:
+  const AsyncWriteSlot* slot_ = nullptr;
+  std::uint64_t seq_ = 0;
+};
+
+// Blocks until every value queued by <prop>_SetAsync() before the call has
+// been written, for all properties of the process.
+void FlushAsyncWrites();
+
+}  // namespace android::sysprop::runtime
+
+#endif  // SYSTEM_TOOLS_SYSPROP_ASYNC_WRITE_H_
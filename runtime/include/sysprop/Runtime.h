@@ -0,0 +1,466 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_TOOLS_SYSPROP_RUNTIME_H_
+#define SYSTEM_TOOLS_SYSPROP_RUNTIME_H_
+
+#include <sys/system_properties.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sysprop/AsyncWrite.h"
+
+// Parsers, formatters and property access shared by every source generated
+// with sysprop_cpp --runtime. The templates are explicitly instantiated in
+// libsysprop_runtime for the built-in property types; generated sources only
+// instantiate them for their own enums.
+
+namespace android::sysprop::runtime {
+
+template <typename T>
+constexpr bool is_optional = false;
+
+template <typename T>
+constexpr bool is_optional<std::optional<T>> = true;
+
+// The parsers and formatters, PropHandle and the templates on top of them are
+// shared with sources generated without --runtime, which sysprop_cpp writes
+// them into. The parts of them which aren't templates are defined in
+// runtime/shared.
+#include "sysprop/shared/Parse.inc"
+
+#include "sysprop/shared/PropHandle.inc"
+
+#include "sysprop/shared/Pmr.inc"
+
+#include "sysprop/shared/InlineList.inc"
+
+#include "sysprop/shared/PropCache.inc"
+
+#include "sysprop/shared/SetIfChanged.inc"
+
+#include "sysprop/shared/BootValue.inc"
+
+#include "sysprop/shared/WaitFor.inc"
+
+// Calls |on_change| on the watcher thread after the property changes. All
+// watches of the process share that one thread, which sleeps on the serial of
+// the property area and only rechecks the serials of watched properties, so
+// several changes in a row may be reported by a single call. Returns an id for
+// RemoveWatch.
+std::uint64_t AddWatch(PropHandle& handle, std::function<void()> on_change);
+
+// Stops a watch. Once this returns, its callback is no longer running and
+// won't be called again, unless this is called from that callback itself.
+void RemoveWatch(std::uint64_t id);
+
+class AsyncWriter;
+
+// Latest value queued for a property by SetPropAsync(), until the writer
+// thread sends it to the property service. Setters only contend on the slot
+// of the property they set. Slots are never destroyed, since the writer
+// thread may outlive static destructors.
+class AsyncWriteSlot {
+ public:
+  explicit AsyncWriteSlot(const char* name) : name_(name) {}
+  AsyncWriteSlot(const AsyncWriteSlot&) = delete;
+  AsyncWriteSlot& operator=(const AsyncWriteSlot&) = delete;
+
+  const char* name() const { return name_; }
+
+  // Replaces the queued value with |value|, and queues the slot for the
+  // writer thread unless it is queued already.
+  WriteToken Queue(const char* value);
+
+ private:
+  friend class AsyncWriter;
+  friend class WriteToken;
+
+  const char* name_;
+  std::mutex mutex_;
+  // Guarded by mutex_.
+  std::string value_;
+  std::uint64_t seq_ = 0;
+  bool queued_ = false;
+  // Link in the stack of queued slots, owned by the writer while queued_.
+  AsyncWriteSlot* next_ = nullptr;
+  // Sequence number of the last value written, and whether that worked.
+  std::atomic<std::uint64_t> written_seq_{0};
+  std::atomic<bool> written_ok_{false};
+};
+
+// Formats |value| on the calling thread and queues it in |slot|. Returns a
+// done token and sets errno to E2BIG if the value is too long.
+template <typename T>
+WriteToken SetPropAsync(AsyncWriteSlot& slot, const T& value,
+                        bool integer_as_bool = false) {
+  ValueBuffer buf(slot.name(), integer_as_bool);
+  FormatValue(buf, value);
+  if (buf.overflowed()) {
+    errno = E2BIG;
+    return WriteToken();
+  }
+  return slot.Queue(buf.c_str());
+}
+
+// Table-driven accessors. Sources generated with --table describe each
+// property with a constexpr PropDescriptor, and every accessor is a call to
+// ReadValue or WriteValue. Both are defined here for enums and specialized
+// in libsysprop_runtime for the built-in types.
+
+struct EnumTable {
+  const char* const* names;
+  // Indices of |names| in the order of the names, which ParseEnumName()
+  // searches through.
+  const std::uint16_t* by_name;
+  std::size_t size;
+};
+
+enum class PropAccess : std::uint8_t { kReadonly, kWriteonce, kReadWrite };
+
+struct PropDescriptor {
+  const char* name;
+  PropHandle* handle;
+  PropAccess access;
+  bool integer_as_bool;
+  // nullptr unless the property is an Enum or EnumList.
+  const EnumTable* enum_table;
+  // Skip writes of the value the property has already.
+  bool elide_writes = false;
+};
+
+// Returns the index of |name| among the names of an Enum or EnumList
+// property, or std::nullopt if it isn't one of them.
+std::optional<std::size_t> ParseEnumName(const PropDescriptor& prop,
+                                         std::string_view name);
+
+// Reads an Enum property as the index of its name.
+std::optional<std::size_t> ReadEnum(const PropDescriptor& prop);
+
+// Reads an EnumList property and passes the indices of its names to
+// |assign|.
+void ReadEnumList(const PropDescriptor& prop,
+                  void (*assign)(void* list,
+                                 const std::optional<std::size_t>* indices,
+                                 std::size_t size),
+                  void* list);
+
+// Sets an Enum property to the name at |index|.
+bool WriteEnum(const PropDescriptor& prop, std::optional<std::size_t> index);
+
+// Sets an EnumList property to the names at the indices returned by
+// |index_at| for each of the |size| elements of |list|.
+bool WriteEnumList(const PropDescriptor& prop, std::size_t size,
+                   std::optional<std::size_t> (*index_at)(const void* list,
+                                                          std::size_t i),
+                   const void* list);
+
+// Same as WriteEnum and WriteEnumList, through |slot|.
+WriteToken WriteEnumAsync(const PropDescriptor& prop, AsyncWriteSlot& slot,
+                          std::optional<std::size_t> index);
+WriteToken WriteEnumListAsync(
+    const PropDescriptor& prop, AsyncWriteSlot& slot, std::size_t size,
+    std::optional<std::size_t> (*index_at)(const void* list, std::size_t i),
+    const void* list);
+
+// Enums are handled by the type-erased functions above, so each enum type
+// only instantiates these thin conversions. Lists may be vectors or the
+// InlineList or EnumSet of a generated header.
+template <typename T>
+void ReadEnumListInto(const PropDescriptor& prop, T* list) {
+  using E = typename T::value_type::value_type;
+  ReadEnumList(
+      prop,
+      [](void* list, const std::optional<std::size_t>* indices,
+         std::size_t size) {
+        auto ret = static_cast<T*>(list);
+        ret->reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+          ret->emplace_back(
+              indices[i] ? std::make_optional(static_cast<E>(*indices[i]))
+                         : std::nullopt);
+        }
+      },
+      list);
+}
+
+template <typename T>
+T ReadValue(const PropDescriptor& prop) {
+  if constexpr (!is_optional<T>) {
+    T ret;
+    ReadEnumListInto(prop, &ret);
+    return ret;
+  } else {
+    using E = typename T::value_type;
+    auto index = ReadEnum(prop);
+    return index ? std::make_optional(static_cast<E>(*index)) : std::nullopt;
+  }
+}
+
+// Reads an EnumList property into a pmr vector allocated from |resource|.
+template <typename T>
+T ReadValue(const PropDescriptor& prop, std::pmr::memory_resource& resource) {
+  T ret(&resource);
+  ReadEnumListInto(prop, &ret);
+  return ret;
+}
+
+template <typename T>
+bool WriteValue(const PropDescriptor& prop, const T& value) {
+  if constexpr (is_vector<T>) {
+    return WriteEnumList(
+        prop, value.size(),
+        [](const void* list, std::size_t i) -> std::optional<std::size_t> {
+          auto& element = (*static_cast<const T*>(list))[i];
+          if (!element) return std::nullopt;
+          return static_cast<std::size_t>(*element);
+        },
+        &value);
+  } else {
+    if (!value) return WriteEnum(prop, std::nullopt);
+    return WriteEnum(prop, static_cast<std::size_t>(*value));
+  }
+}
+
+// Same as WriteValue, through |slot|. Sources generated with --table only
+// call this for enums, and SetPropAsync for the built-in types.
+template <typename T>
+WriteToken WriteValueAsync(const PropDescriptor& prop, AsyncWriteSlot& slot,
+                           const T& value) {
+  if constexpr (is_vector<T>) {
+    return WriteEnumListAsync(
+        prop, slot, value.size(),
+        [](const void* list, std::size_t i) -> std::optional<std::size_t> {
+          auto& element = (*static_cast<const T*>(list))[i];
+          if (!element) return std::nullopt;
+          return static_cast<std::size_t>(*element);
+        },
+        &value);
+  } else {
+    if (!value) return WriteEnumAsync(prop, slot, std::nullopt);
+    return WriteEnumAsync(prop, slot, static_cast<std::size_t>(*value));
+  }
+}
+
+template <>
+std::optional<bool> ReadValue(const PropDescriptor& prop);
+template <>
+std::optional<std::int32_t> ReadValue(const PropDescriptor& prop);
+template <>
+std::optional<std::int64_t> ReadValue(const PropDescriptor& prop);
+template <>
+std::optional<double> ReadValue(const PropDescriptor& prop);
+template <>
+std::optional<std::string> ReadValue(const PropDescriptor& prop);
+template <>
+std::vector<std::optional<bool>> ReadValue(const PropDescriptor& prop);
+template <>
+std::vector<std::optional<std::int32_t>> ReadValue(const PropDescriptor& prop);
+template <>
+std::vector<std::optional<std::int64_t>> ReadValue(const PropDescriptor& prop);
+template <>
+std::vector<std::optional<double>> ReadValue(const PropDescriptor& prop);
+template <>
+std::vector<std::optional<std::string>> ReadValue(const PropDescriptor& prop);
+
+template <>
+bool WriteValue(const PropDescriptor& prop, const std::optional<bool>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::int32_t>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::int64_t>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop, const std::optional<double>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::optional<std::string>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<bool>>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::int32_t>>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::int64_t>>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<double>>& value);
+template <>
+bool WriteValue(const PropDescriptor& prop,
+                const std::vector<std::optional<std::string>>& value);
+
+extern template std::vector<std::optional<bool>> DoParseList(std::string_view);
+extern template std::vector<std::optional<std::int32_t>> DoParseList(
+    std::string_view);
+extern template std::vector<std::optional<std::int64_t>> DoParseList(
+    std::string_view);
+extern template std::vector<std::optional<double>> DoParseList(
+    std::string_view);
+extern template std::vector<std::optional<std::string>> DoParseList(
+    std::string_view);
+
+extern template void FormatValue(ValueBuffer&,
+                                 const std::vector<std::optional<bool>>&);
+extern template void FormatValue(
+    ValueBuffer&, const std::vector<std::optional<std::int32_t>>&);
+extern template void FormatValue(
+    ValueBuffer&, const std::vector<std::optional<std::int64_t>>&);
+extern template void FormatValue(ValueBuffer&,
+                                 const std::vector<std::optional<double>>&);
+extern template void FormatValue(
+    ValueBuffer&, const std::vector<std::optional<std::string>>&);
+
+extern template std::optional<bool> GetProp(PropHandle&);
+extern template std::optional<std::int32_t> GetProp(PropHandle&);
+extern template std::optional<std::int64_t> GetProp(PropHandle&);
+extern template std::optional<double> GetProp(PropHandle&);
+extern template std::optional<std::string> GetProp(PropHandle&);
+extern template std::vector<std::optional<bool>> GetProp(PropHandle&);
+extern template std::vector<std::optional<std::int32_t>> GetProp(PropHandle&);
+extern template std::vector<std::optional<std::int64_t>> GetProp(PropHandle&);
+extern template std::vector<std::optional<double>> GetProp(PropHandle&);
+extern template std::vector<std::optional<std::string>> GetProp(PropHandle&);
+extern template std::optional<std::pmr::string> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+extern template std::pmr::vector<std::optional<bool>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+extern template std::pmr::vector<std::optional<std::int32_t>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+extern template std::pmr::vector<std::optional<std::int64_t>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+extern template std::pmr::vector<std::optional<double>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+extern template std::pmr::vector<std::optional<std::pmr::string>> GetProp(
+    PropHandle&, std::pmr::memory_resource&);
+
+extern template bool SetProp(const char*, const std::optional<bool>&, bool);
+extern template bool SetProp(const char*, const std::optional<std::int32_t>&,
+                             bool);
+extern template bool SetProp(const char*, const std::optional<std::int64_t>&,
+                             bool);
+extern template bool SetProp(const char*, const std::optional<double>&, bool);
+extern template bool SetProp(const char*, const std::optional<std::string>&,
+                             bool);
+extern template bool SetProp(const char*,
+                             const std::vector<std::optional<bool>>&, bool);
+extern template bool SetProp(const char*,
+                             const std::vector<std::optional<std::int32_t>>&,
+                             bool);
+extern template bool SetProp(const char*,
+                             const std::vector<std::optional<std::int64_t>>&,
+                             bool);
+extern template bool SetProp(const char*,
+                             const std::vector<std::optional<double>>&, bool);
+extern template bool SetProp(const char*,
+                             const std::vector<std::optional<std::string>>&,
+                             bool);
+
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::optional<bool>&, bool,
+                                     PropCache<std::optional<bool>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::optional<std::int32_t>&, bool,
+                                     PropCache<std::optional<std::int32_t>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::optional<std::int64_t>&, bool,
+                                     PropCache<std::optional<std::int64_t>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::optional<double>&, bool,
+                                     PropCache<std::optional<double>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::optional<std::string>&, bool,
+                                     PropCache<std::optional<std::string>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::vector<std::optional<bool>>&, bool,
+                                     PropCache<std::vector<std::optional<bool>>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::vector<std::optional<std::int32_t>>&, bool,
+                                     PropCache<std::vector<std::optional<std::int32_t>>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::vector<std::optional<std::int64_t>>&, bool,
+                                     PropCache<std::vector<std::optional<std::int64_t>>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::vector<std::optional<double>>&, bool,
+                                     PropCache<std::vector<std::optional<double>>>*);
+extern template bool SetPropIfChanged(PropHandle&, const char*,
+                                     const std::vector<std::optional<std::string>>&, bool,
+                                     PropCache<std::vector<std::optional<std::string>>>*);
+
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::optional<bool>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::optional<std::int32_t>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::optional<std::int64_t>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::optional<double>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::optional<std::string>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::vector<std::optional<bool>>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::vector<std::optional<std::int32_t>>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::vector<std::optional<std::int64_t>>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::vector<std::optional<double>>&, bool);
+extern template WriteToken SetPropAsync(AsyncWriteSlot&,
+                                       const std::vector<std::optional<std::string>>&, bool);
+
+extern template class PropCache<std::optional<bool>>;
+extern template class PropCache<std::optional<std::int32_t>>;
+extern template class PropCache<std::optional<std::int64_t>>;
+extern template class PropCache<std::optional<double>>;
+extern template class PropCache<std::optional<std::string>>;
+extern template class PropCache<std::vector<std::optional<bool>>>;
+extern template class PropCache<std::vector<std::optional<std::int32_t>>>;
+extern template class PropCache<std::vector<std::optional<std::int64_t>>>;
+extern template class PropCache<std::vector<std::optional<double>>>;
+extern template class PropCache<std::vector<std::optional<std::string>>>;
+
+extern template class BootValue<std::optional<bool>>;
+extern template class BootValue<std::optional<std::int32_t>>;
+extern template class BootValue<std::optional<std::int64_t>>;
+extern template class BootValue<std::optional<double>>;
+extern template class BootValue<std::optional<std::string>>;
+extern template class BootValue<std::vector<std::optional<bool>>>;
+extern template class BootValue<std::vector<std::optional<std::int32_t>>>;
+extern template class BootValue<std::vector<std::optional<std::int64_t>>>;
+extern template class BootValue<std::vector<std::optional<double>>>;
+extern template class BootValue<std::vector<std::optional<std::string>>>;
+
+}  // namespace android::sysprop::runtime
+
+#endif  // SYSTEM_TOOLS_SYSPROP_RUNTIME_H_
@@ -19,10 +19,12 @@
 
 #include <android-base/file.h>
 #include <android-base/scopeguard.h>
+#include <android-base/strings.h>
 #include <android-base/test_utils.h>
 #include <gtest/gtest.h>
 
 #include "CppGen.h"
+#include "RuntimeFragments.h"
 
 namespace {
 
@@ -195,298 +197,1133 @@ constexpr const char* kExpectedSourceOutput =
 
 #include <properties/PlatformProperties.sysprop.h>
 
-#include <cctype>
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
-#include <cstdio>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <utility>
 
-#include <strings.h>
 #include <sys/system_properties.h>
 
-#include <android-base/parseint.h>
 #include <log/log.h>
 
 namespace {
 
 using namespace android::sysprop::PlatformProperties;
 
-template <typename T> T DoParse(const char* str);
+)";
+
+// Follows kExpectedSourceOutput, after the parsers of libsysprop_runtime.
+constexpr const char* kExpectedSourceOutputEnums =
+    R"(template <>
+std::optional<test_enum_values> DoParse(std::string_view str) {
+    switch (str.size()) {
+        case 1:
+            switch (str[0]) {
+                case 'D':
+                    return test_enum_values::D;
+                case 'G':
+                    return test_enum_values::G;
+                case 'a':
+                    return test_enum_values::A;
+                case 'b':
+                    return test_enum_values::B;
+                case 'c':
+                    return test_enum_values::C;
+                case 'e':
+                    return test_enum_values::E;
+                case 'f':
+                    return test_enum_values::F;
+            }
+            break;
+    }
+    return std::nullopt;
+}
+
+constexpr const char* test_enum_names[] = {
+    "a",
+    "b",
+    "c",
+    "D",
+    "e",
+    "f",
+    "G",
+};
+
+void FormatValue(ValueBuffer& buf, std::optional<test_enum_values> value) {
+    if (!value) return;
+    auto index = static_cast<std::size_t>(*value);
+    if (index < std::size(test_enum_names)) {
+        buf.Append(test_enum_names[index]);
+        return;
+    }
+    LOG_ALWAYS_FATAL("Invalid value %d for property android.test.enum", static_cast<std::int32_t>(*value));
+}
+
+template <>
+std::optional<el_values> DoParse(std::string_view str) {
+    switch (str.size()) {
+        case 3:
+            switch (str[0]) {
+                case 'e':
+                    if (std::memcmp(str.data() + 1, "nu", 2) == 0) return el_values::ENU;
+                    break;
+                case 'l':
+                    if (std::memcmp(str.data() + 1, "ue", 2) == 0) return el_values::LUE;
+                    break;
+                case 'm':
+                    if (std::memcmp(str.data() + 1, "va", 2) == 0) return el_values::MVA;
+                    break;
+            }
+            break;
+    }
+    return std::nullopt;
+}
+
+constexpr const char* el_names[] = {
+    "enu",
+    "mva",
+    "lue",
+};
+
+void FormatValue(ValueBuffer& buf, std::optional<el_values> value) {
+    if (!value) return;
+    auto index = static_cast<std::size_t>(*value);
+    if (index < std::size(el_names)) {
+        buf.Append(el_names[index]);
+        return;
+    }
+    LOG_ALWAYS_FATAL("Invalid value %d for property el", static_cast<std::int32_t>(*value));
+}
+
+)";
+
+// Follows kExpectedSourceOutputEnums, after the rest of the fragments.
+constexpr const char* kExpectedSourceOutputTail =
+    R"(PropHandle prop_handles[] = {
+    {"android.test_double"},
+    {"android.test_int"},
+    {"android.test.string"},
+    {"android.test.enum"},
+    {"ro.android.test.b"},
+    {"android.os_test-long"},
+    {"test_double_list"},
+    {"test_list_int"},
+    {"test.strlist"},
+    {"el"},
+};
+
+}  // namespace
+
+namespace android::sysprop::PlatformProperties {
+
+std::optional<double> test_double() {
+    return GetProp<std::optional<double>>(prop_handles[0]);
+}
+
+bool test_double(const std::optional<double>& value) {
+    return SetProp("android.test_double", value);
+}
+
+std::optional<std::int32_t> test_int() {
+    return GetProp<std::optional<std::int32_t>>(prop_handles[1]);
+}
+
+bool test_int(const std::optional<std::int32_t>& value) {
+    return SetProp("android.test_int", value);
+}
+
+std::optional<std::string> test_string() {
+    return GetProp<std::optional<std::string>>(prop_handles[2]);
+}
+
+bool test_string(const std::optional<std::string>& value) {
+    return SetProp("android.test.string", value);
+}
+
+std::optional<test_enum_values> test_enum() {
+    return GetProp<std::optional<test_enum_values>>(prop_handles[3]);
+}
+
+bool test_enum(const std::optional<test_enum_values>& value) {
+    return SetProp("android.test.enum", value);
+}
+
+std::optional<bool> test_BOOLeaN() {
+    return GetProp<std::optional<bool>>(prop_handles[4]);
+}
+
+bool test_BOOLeaN(const std::optional<bool>& value) {
+    return SetProp("ro.android.test.b", value);
+}
+
+std::optional<std::int64_t> android_os_test_long() {
+    return GetProp<std::optional<std::int64_t>>(prop_handles[5]);
+}
+
+bool android_os_test_long(const std::optional<std::int64_t>& value) {
+    return SetProp("android.os_test-long", value);
+}
+
+std::vector<std::optional<double>> test_double_list() {
+    return GetProp<std::vector<std::optional<double>>>(prop_handles[6]);
+}
+
+bool test_double_list(const std::vector<std::optional<double>>& value) {
+    return SetProp("test_double_list", value);
+}
+
+std::vector<std::optional<std::int32_t>> test_list_int() {
+    return GetProp<std::vector<std::optional<std::int32_t>>>(prop_handles[7]);
+}
+
+bool test_list_int(const std::vector<std::optional<std::int32_t>>& value) {
+    return SetProp("test_list_int", value);
+}
+
+std::vector<std::optional<std::string>> test_strlist() {
+    return GetProp<std::vector<std::optional<std::string>>>(prop_handles[8]);
+}
+
+bool test_strlist(const std::vector<std::optional<std::string>>& value) {
+    return SetProp("test.strlist", value);
+}
+
+std::vector<std::optional<el_values>> el() {
+    return GetProp<std::vector<std::optional<el_values>>>(prop_handles[9]);
+}
+
+bool el(const std::vector<std::optional<el_values>>& value) {
+    return SetProp("el", value);
+}
+
+}  // namespace android::sysprop::PlatformProperties
+)";
+
+constexpr const char* kTestCachedSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.CachedProperties"
+
+prop {
+    api_name: "cached_int"
+    type: Integer
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "cached_strlist"
+    type: StringList
+    scope: Public
+    access: Readonly
+}
+)";
+
+constexpr const char* kExpectedCachedGettersOutput =
+    R"(namespace android::sysprop::CachedProperties {
+
+std::optional<std::int32_t> cached_int() {
+    static PropCache<std::optional<std::int32_t>> cache;
+    return cache.Get(prop_handles[0]);
+}
+
+bool cached_int(const std::optional<std::int32_t>& value) {
+    return SetProp("cached_int", value);
+}
+
+std::vector<std::optional<std::string>> cached_strlist() {
+    static PropCache<std::vector<std::optional<std::string>>> cache;
+    return cache.Get(prop_handles[1]);
+}
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedPrewarmHeaderOutput =
+    R"(std::vector<std::optional<std::string>> cached_strlist();
+
+void Prewarm();
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedPrewarmSourceOutput =
+    R"(PropHandle prop_handles[] = {
+    {"cached_int"},
+    {"ro.cached_strlist"},
+};
+
+}  // namespace
+)";
+
+constexpr const char* kExpectedPrewarmOutput =
+    R"(void Prewarm() {
+    for (auto& handle : prop_handles) handle.Find();
+}
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedSnapshotHeaderOutput =
+    R"(std::vector<std::optional<std::string>> cached_strlist();
+
+inline namespace internal_scope {
+
+struct CachedPropertiesSnapshot {
+    std::optional<std::int32_t> cached_int;
+    std::vector<std::optional<std::string>> cached_strlist;
+    std::uint32_t area_serial = 0;
+};
+
+void ReadSnapshot(CachedPropertiesSnapshot* snapshot);
+bool IsStale(const CachedPropertiesSnapshot& snapshot);
+
+}  // namespace internal_scope
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedSnapshotSystemHeaderOutput =
+    R"(std::vector<std::optional<std::string>> cached_strlist();
+
+inline namespace system_scope {
+
+struct CachedPropertiesSnapshot {
+    std::vector<std::optional<std::string>> cached_strlist;
+    std::uint32_t area_serial = 0;
+};
+
+void ReadSnapshot(CachedPropertiesSnapshot* snapshot);
+bool IsStale(const CachedPropertiesSnapshot& snapshot);
+
+}  // namespace system_scope
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedSnapshotSourceOutput =
+    R"(inline namespace internal_scope {
+
+void ReadSnapshot(CachedPropertiesSnapshot* snapshot) {
+    std::uint32_t area_serial = __system_property_area_serial();
+    snapshot->cached_int = cached_int();
+    snapshot->cached_strlist = cached_strlist();
+    snapshot->area_serial = area_serial;
+}
+
+bool IsStale(const CachedPropertiesSnapshot& snapshot) {
+    return snapshot.area_serial == 0 || snapshot.area_serial != __system_property_area_serial();
+}
+
+}  // namespace internal_scope
+
+inline namespace system_scope {
+
+struct CachedPropertiesSnapshot {
+    std::vector<std::optional<std::string>> cached_strlist;
+    std::uint32_t area_serial = 0;
+};
+
+void ReadSnapshot(CachedPropertiesSnapshot* snapshot) {
+    std::uint32_t area_serial = __system_property_area_serial();
+    snapshot->cached_strlist = cached_strlist();
+    snapshot->area_serial = area_serial;
+}
+
+bool IsStale(const CachedPropertiesSnapshot& snapshot) {
+    return snapshot.area_serial == 0 || snapshot.area_serial != __system_property_area_serial();
+}
+
+}  // namespace system_scope
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kTestRuntimeSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.RuntimeProperties"
+
+prop {
+    api_name: "mode"
+    type: Enum
+    enum_values: "on|off"
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "count"
+    type: Integer
+    scope: Internal
+    access: Readonly
+}
+)";
+
+constexpr const char* kExpectedRuntimeSourceOutput =
+    R"(// Generated by the sysprop generator. DO NOT EDIT!
+
+#include <properties/TestProperties.sysprop.h>
+
+#include <cstring>
+
+#include <log/log.h>
+#include <sysprop/Runtime.h>
+
+namespace android::sysprop::runtime {
+
+template <>
+std::optional<android::sysprop::RuntimeProperties::mode_values> DoParse(std::string_view str) {
+    switch (str.size()) {
+        case 2:
+            switch (str[0]) {
+                case 'o':
+                    if (std::memcmp(str.data() + 1, "n", 1) == 0) return android::sysprop::RuntimeProperties::mode_values::ON;
+                    break;
+            }
+            break;
+        case 3:
+            switch (str[0]) {
+                case 'o':
+                    if (std::memcmp(str.data() + 1, "ff", 2) == 0) return android::sysprop::RuntimeProperties::mode_values::OFF;
+                    break;
+            }
+            break;
+    }
+    return std::nullopt;
+}
+
+constexpr const char* mode_names[] = {
+    "on",
+    "off",
+};
+
+void FormatValue(ValueBuffer& buf, std::optional<android::sysprop::RuntimeProperties::mode_values> value) {
+    if (!value) return;
+    auto index = static_cast<std::size_t>(*value);
+    if (index < std::size(mode_names)) {
+        buf.Append(mode_names[index]);
+        return;
+    }
+    LOG_ALWAYS_FATAL("Invalid value %d for property mode", static_cast<std::int32_t>(*value));
+}
+
+}  // namespace android::sysprop::runtime
+
+namespace {
+
+using namespace android::sysprop::runtime;
+
+PropHandle prop_handles[] = {
+    {"mode"},
+    {"ro.count"},
+};
+
+}  // namespace
+
+namespace android::sysprop::RuntimeProperties {
+
+std::optional<mode_values> mode() {
+    return GetProp<std::optional<mode_values>>(prop_handles[0]);
+}
+
+bool mode(const std::optional<mode_values>& value) {
+    return SetProp("mode", value);
+}
+
+std::optional<std::int32_t> count() {
+    return GetProp<std::optional<std::int32_t>>(prop_handles[1]);
+}
+
+}  // namespace android::sysprop::RuntimeProperties
+)";
+
+constexpr const char* kExpectedTableSourceOutput =
+    R"(// Generated by the sysprop generator. DO NOT EDIT!
+
+#include <properties/TestProperties.sysprop.h>
+
+#include <cstring>
+
+#include <log/log.h>
+#include <sysprop/Runtime.h>
+
+namespace {
+
+using namespace android::sysprop::runtime;
+
+PropHandle prop_handles[] = {
+    {"mode"},
+    {"ro.count"},
+};
+
+constexpr const char* mode_names[] = {
+    "on",
+    "off",
+};
+
+constexpr std::uint16_t mode_by_name[] = {1, 0};
+
+constexpr EnumTable mode_enum_table = {mode_names, mode_by_name, std::size(mode_names)};
+
+constexpr PropDescriptor prop_descriptors[] = {
+    {"mode", &prop_handles[0], PropAccess::kReadWrite, false, &mode_enum_table},
+    {"ro.count", &prop_handles[1], PropAccess::kReadonly, false, nullptr},
+};
+
+}  // namespace
+
+namespace android::sysprop::RuntimeProperties {
+
+std::optional<mode_values> mode() {
+    return ReadValue<std::optional<mode_values>>(prop_descriptors[0]);
+}
+
+bool mode(const std::optional<mode_values>& value) {
+    return WriteValue(prop_descriptors[0], value);
+}
+
+std::optional<std::int32_t> count() {
+    return ReadValue<std::optional<std::int32_t>>(prop_descriptors[1]);
+}
+
+}  // namespace android::sysprop::RuntimeProperties
+)";
+
+constexpr const char* kExpectedWatcherHeaderOutput =
+    R"(inline namespace internal_scope {
+
+class Watcher {
+  public:
+    Watcher() = default;
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+    ~Watcher();
+
+    void mode_OnChange(std::function<void(const std::optional<mode_values>&)> callback);
+    void count_OnChange(std::function<void(const std::optional<std::int32_t>&)> callback);
+
+  private:
+    std::vector<std::uint64_t> watch_ids_;
+};
+
+}  // namespace internal_scope
+
+}  // namespace android::sysprop::RuntimeProperties
+)";
+
+constexpr const char* kExpectedWatcherSourceOutput =
+    R"(inline namespace internal_scope {
+
+Watcher::~Watcher() {
+    for (auto id : watch_ids_) RemoveWatch(id);
+}
+
+void Watcher::mode_OnChange(std::function<void(const std::optional<mode_values>&)> callback) {
+    watch_ids_.push_back(AddWatch(prop_handles[0], [callback = std::move(callback)] { callback(mode()); }));
+}
+
+void Watcher::count_OnChange(std::function<void(const std::optional<std::int32_t>&)> callback) {
+    watch_ids_.push_back(AddWatch(prop_handles[1], [callback = std::move(callback)] { callback(count()); }));
+}
+
+}  // namespace internal_scope
+
+inline namespace system_scope {
+
+class Watcher {
+  public:
+    Watcher() = default;
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+    ~Watcher();
+
+  private:
+    std::vector<std::uint64_t> watch_ids_;
+};
+
+Watcher::~Watcher() {
+    for (auto id : watch_ids_) RemoveWatch(id);
+}
+
+}  // namespace system_scope
+
+}  // namespace android::sysprop::RuntimeProperties
+)";
+
+constexpr const char* kTestCachePolicySyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.CachePolicyProperties"
+
+prop {
+    api_name: "boot_int"
+    type: Integer
+    scope: Internal
+    access: Readonly
+    cache_policy: Boot
+}
+prop {
+    api_name: "serial_strlist"
+    type: StringList
+    scope: Internal
+    access: ReadWrite
+    cache_policy: Serial
+}
+)";
+
+constexpr const char* kExpectedCachePolicyHeaderOutput =
+    R"(namespace android::sysprop::CachePolicyProperties {
+
+const std::optional<std::int32_t>& boot_int();
+
+std::vector<std::optional<std::string>> serial_strlist();
+bool serial_strlist(const std::vector<std::optional<std::string>>& value);
+
+}  // namespace android::sysprop::CachePolicyProperties
+)";
+
+constexpr const char* kExpectedCachePolicySourceOutput =
+    R"(namespace android::sysprop::CachePolicyProperties {
+
+const std::optional<std::int32_t>& boot_int() {
+    static BootValue<std::optional<std::int32_t>> value;
+    return value.Get(prop_handles[0]);
+}
+
+std::vector<std::optional<std::string>> serial_strlist() {
+    static PropCache<std::vector<std::optional<std::string>>> cache;
+    return cache.Get(prop_handles[1]);
+}
+
+bool serial_strlist(const std::vector<std::optional<std::string>>& value) {
+    return SetProp("serial_strlist", value);
+}
+
+}  // namespace android::sysprop::CachePolicyProperties
+)";
+
+constexpr const char* kExpectedWaitForHeaderOutput =
+    R"(#include <chrono>
+#include <functional>
+
+namespace android::sysprop::CachedProperties {
+
+std::optional<std::int32_t> cached_int();
+bool cached_int(const std::optional<std::int32_t>& value);
+bool cached_int_WaitFor(const std::function<bool(const std::optional<std::int32_t>&)>& predicate, std::chrono::nanoseconds timeout);
+
+std::vector<std::optional<std::string>> cached_strlist();
+bool cached_strlist_WaitFor(const std::function<bool(const std::vector<std::optional<std::string>>&)>& predicate, std::chrono::nanoseconds timeout);
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kExpectedWaitForSourceOutput =
+    R"(namespace android::sysprop::CachedProperties {
+
+std::optional<std::int32_t> cached_int() {
+    return GetProp<std::optional<std::int32_t>>(prop_handles[0]);
+}
+
+bool cached_int(const std::optional<std::int32_t>& value) {
+    return SetProp("cached_int", value);
+}
+
+bool cached_int_WaitFor(const std::function<bool(const std::optional<std::int32_t>&)>& predicate, std::chrono::nanoseconds timeout) {
+    return WaitForProp<std::optional<std::int32_t>>(prop_handles[0], [] { return cached_int(); }, predicate, timeout);
+}
+
+std::vector<std::optional<std::string>> cached_strlist() {
+    return GetProp<std::vector<std::optional<std::string>>>(prop_handles[1]);
+}
+
+bool cached_strlist_WaitFor(const std::function<bool(const std::vector<std::optional<std::string>>&)>& predicate, std::chrono::nanoseconds timeout) {
+    return WaitForProp<std::vector<std::optional<std::string>>>(prop_handles[1], [] { return cached_strlist(); }, predicate, timeout);
+}
+
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kTestInlineListsSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.InlineListProperties"
+
+prop {
+    api_name: "ints"
+    type: IntegerList
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "names"
+    type: StringList
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "boot_ints"
+    type: IntegerList
+    scope: Internal
+    access: Readonly
+}
+)";
 
-constexpr const std::pair<const char*, test_enum_values> test_enum_list[] = {
-    {"a", test_enum_values::A},
-    {"b", test_enum_values::B},
-    {"c", test_enum_values::C},
-    {"D", test_enum_values::D},
-    {"e", test_enum_values::E},
-    {"f", test_enum_values::F},
-    {"G", test_enum_values::G},
-};
+constexpr const char* kExpectedInlineListsHeaderOutput =
+    R"(std::vector<std::optional<std::int32_t>> ints();
+InlineList<std::optional<std::int32_t>> ints_Inline();
+bool ints(const std::vector<std::optional<std::int32_t>>& value);
 
-template <>
-std::optional<test_enum_values> DoParse(const char* str) {
-    for (auto [name, val] : test_enum_list) {
-        if (strcmp(str, name) == 0) {
-            return val;
-        }
-    }
-    return std::nullopt;
+std::vector<std::optional<std::string>> names();
+InlineStringList names_Inline();
+bool names(const std::vector<std::optional<std::string>>& value);
+
+std::vector<std::optional<std::int32_t>> boot_ints();
+
+}  // namespace android::sysprop::InlineListProperties
+)";
+
+constexpr const char* kExpectedInlineListsSourceOutput =
+    R"(namespace android::sysprop::InlineListProperties {
+
+std::vector<std::optional<std::int32_t>> ints() {
+    return GetProp<std::vector<std::optional<std::int32_t>>>(prop_handles[0]);
 }
 
-std::string FormatValue(std::optional<test_enum_values> value) {
-    if (!value) return "";
-    for (auto [name, val] : test_enum_list) {
-        if (val == *value) {
-            return name;
-        }
-    }
-    LOG_ALWAYS_FATAL("Invalid value %d for property android.test.enum", static_cast<std::int32_t>(*value));
-    __builtin_unreachable();
+InlineList<std::optional<std::int32_t>> ints_Inline() {
+    return GetInlineList<InlineList<std::optional<std::int32_t>>>(prop_handles[0]);
 }
 
-constexpr const std::pair<const char*, el_values> el_list[] = {
-    {"enu", el_values::ENU},
-    {"mva", el_values::MVA},
-    {"lue", el_values::LUE},
-};
+bool ints(const std::vector<std::optional<std::int32_t>>& value) {
+    return SetProp("ints", value);
+}
 
-template <>
-std::optional<el_values> DoParse(const char* str) {
-    for (auto [name, val] : el_list) {
-        if (strcmp(str, name) == 0) {
-            return val;
-        }
-    }
-    return std::nullopt;
+std::vector<std::optional<std::string>> names() {
+    return GetProp<std::vector<std::optional<std::string>>>(prop_handles[1]);
 }
 
-std::string FormatValue(std::optional<el_values> value) {
-    if (!value) return "";
-    for (auto [name, val] : el_list) {
-        if (val == *value) {
-            return name;
-        }
-    }
-    LOG_ALWAYS_FATAL("Invalid value %d for property el", static_cast<std::int32_t>(*value));
-    __builtin_unreachable();
+InlineStringList names_Inline() {
+    return GetInlineList<InlineStringList>(prop_handles[1]);
+}
+
+bool names(const std::vector<std::optional<std::string>>& value) {
+    return SetProp("names", value);
 }
 
-template <typename T> constexpr bool is_vector = false;
+std::vector<std::optional<std::int32_t>> boot_ints() {
+    return GetProp<std::vector<std::optional<std::int32_t>>>(prop_handles[2]);
+}
 
-template <typename T> constexpr bool is_vector<std::vector<T>> = true;
+}  // namespace android::sysprop::InlineListProperties
+)";
 
-template <> [[maybe_unused]] std::optional<bool> DoParse(const char* str) {
-    static constexpr const char* kYes[] = {"1", "true"};
-    static constexpr const char* kNo[] = {"0", "false"};
+constexpr const char* kExpectedPmrHeaderOutput =
+    R"(#include <memory_resource>
 
-    for (const char* yes : kYes) {
-        if (strcasecmp(yes, str) == 0) return std::make_optional(true);
-    }
+namespace android::sysprop::CachedProperties {
 
-    for (const char* no : kNo) {
-        if (strcasecmp(no, str) == 0) return std::make_optional(false);
-    }
+std::optional<std::int32_t> cached_int();
+bool cached_int(const std::optional<std::int32_t>& value);
 
-    return std::nullopt;
-}
+std::vector<std::optional<std::string>> cached_strlist();
+std::pmr::vector<std::optional<std::pmr::string>> cached_strlist(std::pmr::memory_resource& resource);
 
-template <> [[maybe_unused]] std::optional<std::int32_t> DoParse(const char* str) {
-    std::int32_t ret;
-    return android::base::ParseInt(str, &ret) ? std::make_optional(ret) : std::nullopt;
-}
+}  // namespace android::sysprop::CachedProperties
+)";
 
-template <> [[maybe_unused]] std::optional<std::int64_t> DoParse(const char* str) {
-    std::int64_t ret;
-    return android::base::ParseInt(str, &ret) ? std::make_optional(ret) : std::nullopt;
-}
+constexpr const char* kExpectedPmrSourceOutput =
+    R"(namespace android::sysprop::CachedProperties {
 
-template <> [[maybe_unused]] std::optional<double> DoParse(const char* str) {
-    int old_errno = errno;
-    errno = 0;
-    char* end;
-    double ret = std::strtod(str, &end);
-    if (errno != 0) {
-        return std::nullopt;
-    }
-    if (str == end || *end != '\0') {
-        errno = EINVAL;
-        return std::nullopt;
-    }
-    errno = old_errno;
-    return std::make_optional(ret);
-}
-
-template <> [[maybe_unused]] std::optional<std::string> DoParse(const char* str) {
-    return *str == '\0' ? std::nullopt : std::make_optional(str);
-}
-
-template <typename Vec> [[maybe_unused]] Vec DoParseList(const char* str) {
-    Vec ret;
-    const char* p = str;
-    for (;;) {
-        const char* found = p;
-        while (*found != '\0' && *found != ',') {
-            ++found;
-        }
-        std::string value(p, found);
-        ret.emplace_back(DoParse<typename Vec::value_type>(value.c_str()));
-        if (*found == '\0') break;
-        p = found + 1;
-    }
-    return ret;
+std::optional<std::int32_t> cached_int() {
+    return GetProp<std::optional<std::int32_t>>(prop_handles[0]);
 }
 
-template <typename T> inline T TryParse(const char* str) {
-    if constexpr(is_vector<T>) {
-        return DoParseList<T>(str);
-    } else {
-        return DoParse<T>(str);
-    }
+bool cached_int(const std::optional<std::int32_t>& value) {
+    return SetProp("cached_int", value);
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<std::int32_t>& value) {
-    return value ? std::to_string(*value) : "";
+std::vector<std::optional<std::string>> cached_strlist() {
+    return GetProp<std::vector<std::optional<std::string>>>(prop_handles[1]);
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<std::int64_t>& value) {
-    return value ? std::to_string(*value) : "";
+std::pmr::vector<std::optional<std::pmr::string>> cached_strlist(std::pmr::memory_resource& resource) {
+    return GetProp<std::pmr::vector<std::optional<std::pmr::string>>>(prop_handles[1], resource);
 }
 
-[[maybe_unused]] std::string FormatValue(const std::optional<double>& value) {
-    if (!value) return "";
-    char buf[1024];
-    std::sprintf(buf, "%.*g", std::numeric_limits<double>::max_digits10, *value);
-    return buf;
-}
+}  // namespace android::sysprop::CachedProperties
+)";
+
+constexpr const char* kTestCompactSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.CompactProperties"
 
-[[maybe_unused]] std::string FormatValue(const std::optional<bool>& value) {
-    return value ? (*value ? "true" : "false") : "";
+prop {
+    api_name: "mode"
+    type: Enum
+    enum_values: "off|on"
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "features"
+    type: EnumList
+    enum_values: "a|b|c"
+    scope: Internal
+    access: Readonly
+}
+prop {
+    api_name: "flags"
+    type: BooleanList
+    scope: Internal
+    access: ReadWrite
 }
+)";
 
-template <typename T>
-[[maybe_unused]] std::string FormatValue(const std::vector<T>& value) {
-    if (value.empty()) return "";
+constexpr const char* kExpectedCompactHeaderOutput =
+    R"(enum class mode_values : std::uint8_t {
+    OFF,
+    ON,
+};
 
-    std::string ret;
-    bool first = true;
+std::optional<mode_values> mode();
+bool mode(const std::optional<mode_values>& value);
 
-    for (auto&& element : value) {
-        if (!first) ret += ",";
-        else first = false;
-        if constexpr(std::is_same_v<T, std::optional<std::string>>) {
-            if (element) ret += *element;
-        } else {
-            ret += FormatValue(element);
-        }
-    }
+enum class features_values : std::uint8_t {
+    A,
+    B,
+    C,
+};
+
+std::vector<std::optional<features_values>> features();
+EnumSet<features_values, 3> features_Set();
+
+std::vector<std::optional<bool>> flags();
+PackedBoolList flags_Packed();
+bool flags(const std::vector<std::optional<bool>>& value);
+
+}  // namespace android::sysprop::CompactProperties
+)";
 
-    return ret;
+constexpr const char* kExpectedCompactSourceOutput =
+    R"(namespace android::sysprop::CompactProperties {
+
+std::optional<mode_values> mode() {
+    return GetProp<std::optional<mode_values>>(prop_handles[0]);
 }
 
-template <typename T>
-T GetProp(const char* key) {
-    T ret;
-    auto pi = __system_property_find(key);
-    if (pi != nullptr) {
-        __system_property_read_callback(pi, [](void* cookie, const char*, const char* value, std::uint32_t) {
-            *static_cast<T*>(cookie) = TryParse<T>(value);
-        }, &ret);
-    }
-    return ret;
+bool mode(const std::optional<mode_values>& value) {
+    return SetProp("mode", value);
 }
 
-}  // namespace
+std::vector<std::optional<features_values>> features() {
+    return GetProp<std::vector<std::optional<features_values>>>(prop_handles[1]);
+}
 
-namespace android::sysprop::PlatformProperties {
+EnumSet<features_values, 3> features_Set() {
+    return GetInlineList<EnumSet<features_values, 3>>(prop_handles[1]);
+}
 
-std::optional<double> test_double() {
-    return GetProp<std::optional<double>>("android.test_double");
+std::vector<std::optional<bool>> flags() {
+    return GetProp<std::vector<std::optional<bool>>>(prop_handles[2]);
 }
 
-bool test_double(const std::optional<double>& value) {
-    return __system_property_set("android.test_double", FormatValue(value).c_str()) == 0;
+PackedBoolList flags_Packed() {
+    return GetInlineList<PackedBoolList>(prop_handles[2]);
 }
 
-std::optional<std::int32_t> test_int() {
-    return GetProp<std::optional<std::int32_t>>("android.test_int");
+bool flags(const std::vector<std::optional<bool>>& value) {
+    return SetProp("flags", value);
 }
 
-bool test_int(const std::optional<std::int32_t>& value) {
-    return __system_property_set("android.test_int", FormatValue(value).c_str()) == 0;
+}  // namespace android::sysprop::CompactProperties
+)";
+
+constexpr const char* kTestElideWritesSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.ElideWritesProperties"
+
+prop {
+    api_name: "enabled"
+    type: Boolean
+    scope: Internal
+    access: ReadWrite
+    integer_as_bool: true
+}
+prop {
+    api_name: "serial_strlist"
+    type: StringList
+    scope: Internal
+    access: ReadWrite
+    cache_policy: Serial
 }
+)";
 
-std::optional<std::string> test_string() {
-    return GetProp<std::optional<std::string>>("android.test.string");
+constexpr const char* kExpectedElideWritesSourceOutput =
+    R"(namespace android::sysprop::ElideWritesProperties {
+
+std::optional<bool> enabled() {
+    return GetProp<std::optional<bool>>(prop_handles[0]);
 }
 
-bool test_string(const std::optional<std::string>& value) {
-    return __system_property_set("android.test.string", value ? value->c_str() : "") == 0;
+bool enabled(const std::optional<bool>& value) {
+    return SetPropIfChanged(prop_handles[0], "enabled", value, true);
 }
 
-std::optional<test_enum_values> test_enum() {
-    return GetProp<std::optional<test_enum_values>>("android.test.enum");
+static PropCache<std::vector<std::optional<std::string>>> serial_strlist_cache;
+
+std::vector<std::optional<std::string>> serial_strlist() {
+    return serial_strlist_cache.Get(prop_handles[1]);
 }
 
-bool test_enum(const std::optional<test_enum_values>& value) {
-    return __system_property_set("android.test.enum", FormatValue(value).c_str()) == 0;
+bool serial_strlist(const std::vector<std::optional<std::string>>& value) {
+    return SetPropIfChanged(prop_handles[1], "serial_strlist", value, false, &serial_strlist_cache);
 }
 
-std::optional<bool> test_BOOLeaN() {
-    return GetProp<std::optional<bool>>("ro.android.test.b");
+}  // namespace android::sysprop::ElideWritesProperties
+)";
+
+constexpr const char* kExpectedAsyncWritesHeaderOutput =
+    R"(#include <sysprop/AsyncWrite.h>
+
+namespace android::sysprop::ElideWritesProperties {
+
+using android::sysprop::runtime::WriteToken;
+
+std::optional<bool> enabled();
+bool enabled(const std::optional<bool>& value);
+WriteToken enabled_SetAsync(const std::optional<bool>& value);
+
+std::vector<std::optional<std::string>> serial_strlist();
+bool serial_strlist(const std::vector<std::optional<std::string>>& value);
+WriteToken serial_strlist_SetAsync(const std::vector<std::optional<std::string>>& value);
+
+void Flush();
+
+}  // namespace android::sysprop::ElideWritesProperties
+)";
+
+constexpr const char* kExpectedAsyncWritesSourceOutput =
+    R"(namespace android::sysprop::ElideWritesProperties {
+
+std::optional<bool> enabled() {
+    return GetProp<std::optional<bool>>(prop_handles[0]);
 }
 
-bool test_BOOLeaN(const std::optional<bool>& value) {
-    return __system_property_set("ro.android.test.b", FormatValue(value).c_str()) == 0;
+bool enabled(const std::optional<bool>& value) {
+    return SetProp("enabled", value, true);
 }
 
-std::optional<std::int64_t> android_os_test_long() {
-    return GetProp<std::optional<std::int64_t>>("android.os_test-long");
+WriteToken enabled_SetAsync(const std::optional<bool>& value) {
+    static auto& slot = *new AsyncWriteSlot("enabled");
+    return SetPropAsync(slot, value, true);
 }
 
-bool android_os_test_long(const std::optional<std::int64_t>& value) {
-    return __system_property_set("android.os_test-long", FormatValue(value).c_str()) == 0;
+std::vector<std::optional<std::string>> serial_strlist() {
+    static PropCache<std::vector<std::optional<std::string>>> cache;
+    return cache.Get(prop_handles[1]);
 }
 
-std::vector<std::optional<double>> test_double_list() {
-    return GetProp<std::vector<std::optional<double>>>("test_double_list");
+bool serial_strlist(const std::vector<std::optional<std::string>>& value) {
+    return SetProp("serial_strlist", value);
 }
 
-bool test_double_list(const std::vector<std::optional<double>>& value) {
-    return __system_property_set("test_double_list", FormatValue(value).c_str()) == 0;
+WriteToken serial_strlist_SetAsync(const std::vector<std::optional<std::string>>& value) {
+    static auto& slot = *new AsyncWriteSlot("serial_strlist");
+    return SetPropAsync(slot, value);
 }
 
-std::vector<std::optional<std::int32_t>> test_list_int() {
-    return GetProp<std::vector<std::optional<std::int32_t>>>("test_list_int");
+void Flush() {
+    FlushAsyncWrites();
 }
 
-bool test_list_int(const std::vector<std::optional<std::int32_t>>& value) {
-    return __system_property_set("test_list_int", FormatValue(value).c_str()) == 0;
+}  // namespace android::sysprop::ElideWritesProperties
+)";
+
+constexpr const char* kTestTypedHandlesSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.TypedProperties"
+
+prop {
+    api_name: "level"
+    type: Integer
+    scope: Public
+    access: ReadWrite
+}
+prop {
+    api_name: "build_tag"
+    type: String
+    prop_name: "ro.typed.build_tag"
+    scope: Internal
+    access: Readonly
 }
+)";
 
-std::vector<std::optional<std::string>> test_strlist() {
-    return GetProp<std::vector<std::optional<std::string>>>("test.strlist");
+constexpr const char* kExpectedTypedHandlesHeaderOutput =
+    R"(std::optional<std::int32_t> level();
+bool level(const std::optional<std::int32_t>& value);
+
+std::optional<std::string> build_tag();
+
+inline namespace internal_scope {
+
+struct level_tag {
+    static constexpr const char* kName = "level";
+    static constexpr bool kWritable = true;
+    static std::optional<std::int32_t> Get() { return level(); }
+    static bool Set(const std::optional<std::int32_t>& value) { return level(value); }
+};
+inline constexpr Prop<std::optional<std::int32_t>, level_tag> level_prop{};
+
+struct build_tag_tag {
+    static constexpr const char* kName = "ro.typed.build_tag";
+    static constexpr bool kWritable = false;
+    static std::optional<std::string> Get() { return build_tag(); }
+};
+inline constexpr Prop<std::optional<std::string>, build_tag_tag> build_tag_prop{};
+
+inline constexpr auto all_props = std::make_tuple(level_prop, build_tag_prop);
+
+}  // namespace internal_scope
+
+}  // namespace android::sysprop::TypedProperties
+)";
+
+constexpr const char* kExpectedTypedHandlesSystemHeaderOutput =
+    R"(std::optional<std::int32_t> level();
+
+inline namespace system_scope {
+
+struct level_tag {
+    static constexpr const char* kName = "level";
+    static constexpr bool kWritable = false;
+    static std::optional<std::int32_t> Get() { return level(); }
+};
+inline constexpr Prop<std::optional<std::int32_t>, level_tag> level_prop{};
+
+inline constexpr auto all_props = std::make_tuple(level_prop);
+
+}  // namespace system_scope
+
+}  // namespace android::sysprop::TypedProperties
+)";
+
+constexpr const char* kTestCApiSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.CApiProperties"
+
+prop {
+    api_name: "mode"
+    type: Enum
+    enum_values: "on|off"
+    scope: Internal
+    access: ReadWrite
 }
+prop {
+    api_name: "ids"
+    type: LongList
+    prop_name: "ro.capi.ids"
+    scope: Public
+    access: Readonly
+}
+)";
 
-bool test_strlist(const std::vector<std::optional<std::string>>& value) {
-    return __system_property_set("test.strlist", FormatValue(value).c_str()) == 0;
+constexpr const char* kExpectedCApiHeaderOutput =
+    R"(#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    android_sysprop_CApiProperties_mode_ON,
+    android_sysprop_CApiProperties_mode_OFF,
+} android_sysprop_CApiProperties_mode_values;
+
+sysprop_status_t android_sysprop_CApiProperties_mode_get(android_sysprop_CApiProperties_mode_values* value);
+sysprop_status_t android_sysprop_CApiProperties_mode_set(const android_sysprop_CApiProperties_mode_values* value);
+
+sysprop_status_t android_sysprop_CApiProperties_ids_get(int64_t* values, bool* present, size_t* size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+)";
+
+constexpr const char* kExpectedCApiSourceOutput =
+    R"(extern "C" {
+
+sysprop_status_t android_sysprop_CApiProperties_mode_get(android_sysprop_CApiProperties_mode_values* value) {
+    return GetCValue(prop_handles[0], DoParse<std::optional<android::sysprop::CApiProperties::mode_values>>, value);
 }
 
-std::vector<std::optional<el_values>> el() {
-    return GetProp<std::vector<std::optional<el_values>>>("el");
+sysprop_status_t android_sysprop_CApiProperties_mode_set(const android_sysprop_CApiProperties_mode_values* value) {
+    return SetCValue("mode", false, [value](ValueBuffer& buf) { FormatValue(buf, FromCValue<android::sysprop::CApiProperties::mode_values>(value)); });
 }
 
-bool el(const std::vector<std::optional<el_values>>& value) {
-    return __system_property_set("el", FormatValue(value).c_str()) == 0;
+sysprop_status_t android_sysprop_CApiProperties_ids_get(int64_t* values, bool* present, size_t* size) {
+    return GetCList(prop_handles[1], DoParse<std::optional<int64_t>>, values, present, size);
 }
 
-}  // namespace android::sysprop::PlatformProperties
+}  // extern "C"
 )";
 
 }  // namespace
 
 using namespace std::string_literals;
 
+namespace {
+
+// Runs the generator on |sysprop| and reads back the headers and the source it
+// produced.
+void GenerateCppCode(const char* sysprop, const CppGenOptions& options,
+                     std::string* header_output,
+                     std::string* system_header_output,
+                     std::string* source_output,
+                     std::string* c_header_output = nullptr) {
+  TemporaryDir temp_dir;
+
+  std::string temp_sysprop_path = temp_dir.path + "/TestProperties.sysprop"s;
+  ASSERT_TRUE(android::base::WriteStringToFile(sysprop, temp_sysprop_path));
+
+  std::string header_output_path = temp_dir.path + "/TestProperties.sysprop.h"s;
+  std::string system_header_output_path =
+      temp_dir.path + "/system/TestProperties.sysprop.h"s;
+  std::string source_output_path =
+      temp_dir.path + "/TestProperties.sysprop.cpp"s;
+  std::string c_header_output_path =
+      temp_dir.path + "/TestProperties.sysprop_c.h"s;
+
+  auto deleter = android::base::make_scope_guard([&] {
+    unlink(temp_sysprop_path.c_str());
+    unlink(header_output_path.c_str());
+    unlink(system_header_output_path.c_str());
+    rmdir((temp_dir.path + "/system"s).c_str());
+    unlink(source_output_path.c_str());
+    unlink(c_header_output_path.c_str());
+  });
+
+  std::string err;
+  ASSERT_TRUE(GenerateCppFiles(temp_sysprop_path, temp_dir.path,
+                               temp_dir.path + "/system"s, temp_dir.path,
+                               "properties/TestProperties.sysprop.h", options,
+                               &err));
+  ASSERT_TRUE(err.empty());
+
+  ASSERT_TRUE(android::base::ReadFileToString(header_output_path,
+                                              header_output, true));
+  ASSERT_TRUE(android::base::ReadFileToString(system_header_output_path,
+                                              system_header_output, true));
+  ASSERT_TRUE(android::base::ReadFileToString(source_output_path,
+                                              source_output, true));
+  if (c_header_output != nullptr) {
+    ASSERT_TRUE(android::base::ReadFileToString(c_header_output_path,
+                                                c_header_output, true));
+  }
+}
+
+}  // namespace
+
 TEST(SyspropTest, CppGenTest) {
   TemporaryDir temp_dir;
 
@@ -500,7 +1337,8 @@ TEST(SyspropTest, CppGenTest) {
   std::string err;
   ASSERT_TRUE(GenerateCppFiles(
       temp_sysprop_path, temp_dir.path, temp_dir.path + "/system"s,
-      temp_dir.path, "properties/PlatformProperties.sysprop.h", &err));
+      temp_dir.path, "properties/PlatformProperties.sysprop.h", CppGenOptions(),
+      &err));
   ASSERT_TRUE(err.empty());
 
   std::string header_output_path =
@@ -529,5 +1367,310 @@ TEST(SyspropTest, CppGenTest) {
   std::string source_output;
   ASSERT_TRUE(android::base::ReadFileToString(source_output_path,
                                               &source_output, true));
-  EXPECT_EQ(source_output, kExpectedSourceOutput);
+  EXPECT_EQ(source_output,
+            kExpectedSourceOutput + std::string(kParseFragment) + "\n" +
+                kExpectedSourceOutputEnums + kParseImplFragment + "\n" +
+                kPropHandleFragment + "\n" + kPropHandleImplFragment + "\n" +
+                kExpectedSourceOutputTail);
+}
+
+TEST(SyspropTest, CppGenCacheValuesTest) {
+  CppGenOptions options;
+  options.cache_values = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachedSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_NE(source_output.find("class PropCache {"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedCachedGettersOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenPrewarmTest) {
+  CppGenOptions options;
+  options.prewarm = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachedSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedPrewarmHeaderOutput))
+      << header_output;
+  EXPECT_NE(source_output.find(kExpectedPrewarmSourceOutput),
+            std::string::npos)
+      << source_output;
+  EXPECT_TRUE(android::base::EndsWith(source_output, kExpectedPrewarmOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenSnapshotTest) {
+  CppGenOptions options;
+  options.snapshot = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachedSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedSnapshotHeaderOutput))
+      << header_output;
+  EXPECT_TRUE(android::base::EndsWith(system_header_output,
+                                      kExpectedSnapshotSystemHeaderOutput))
+      << system_header_output;
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedSnapshotSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenRuntimeTest) {
+  CppGenOptions options;
+  options.runtime = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestRuntimeSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_EQ(source_output, kExpectedRuntimeSourceOutput);
+}
+
+TEST(SyspropTest, CppGenTableTest) {
+  CppGenOptions options;
+  options.runtime = true;
+  options.table = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestRuntimeSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_EQ(source_output, kExpectedTableSourceOutput);
+}
+
+TEST(SyspropTest, CppGenTableRequiresRuntime) {
+  TemporaryFile temp_file;
+  close(temp_file.fd);
+  temp_file.fd = -1;
+  ASSERT_TRUE(
+      android::base::WriteStringToFile(kTestRuntimeSyspropFile, temp_file.path));
+
+  TemporaryDir temp_dir;
+  CppGenOptions options;
+  options.table = true;
+
+  std::string err;
+  EXPECT_FALSE(GenerateCppFiles(temp_file.path, temp_dir.path, temp_dir.path,
+                                temp_dir.path, "TestProperties.sysprop.h",
+                                options, &err));
+  EXPECT_EQ(err, "Table-driven accessors require the runtime library");
+}
+
+TEST(SyspropTest, CppGenWatcherTest) {
+  CppGenOptions options;
+  options.runtime = true;
+  options.watcher = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestRuntimeSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedWatcherHeaderOutput))
+      << header_output;
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedWatcherSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenWatcherRequiresRuntime) {
+  TemporaryFile temp_file;
+  close(temp_file.fd);
+  temp_file.fd = -1;
+  ASSERT_TRUE(
+      android::base::WriteStringToFile(kTestRuntimeSyspropFile, temp_file.path));
+
+  TemporaryDir temp_dir;
+  CppGenOptions options;
+  options.watcher = true;
+
+  std::string err;
+  EXPECT_FALSE(GenerateCppFiles(temp_file.path, temp_dir.path, temp_dir.path,
+                                temp_dir.path, "TestProperties.sysprop.h",
+                                options, &err));
+  EXPECT_EQ(err, "Watcher requires the runtime library");
+}
+
+TEST(SyspropTest, CppGenCachePolicyTest) {
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachePolicySyspropFile, CppGenOptions(), &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedCachePolicyHeaderOutput))
+      << header_output;
+  EXPECT_NE(source_output.find("class BootValue {"), std::string::npos);
+  EXPECT_NE(source_output.find("class PropCache {"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedCachePolicySourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenWaitForTest) {
+  CppGenOptions options;
+  options.wait_for = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachedSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedWaitForHeaderOutput))
+      << header_output;
+  EXPECT_NE(source_output.find("bool WaitForProp("), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedWaitForSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenInlineListsTest) {
+  CppGenOptions options;
+  options.inline_lists = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestInlineListsSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_NE(header_output.find("class InlineStringList"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedInlineListsHeaderOutput))
+      << header_output;
+  EXPECT_NE(source_output.find("List GetInlineList("), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedInlineListsSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenPmrTest) {
+  CppGenOptions options;
+  options.pmr = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCachedSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(android::base::EndsWith(header_output, kExpectedPmrHeaderOutput))
+      << header_output;
+  EXPECT_NE(source_output.find("T TryParse(std::string_view str, "
+                               "std::pmr::memory_resource& resource)"),
+            std::string::npos);
+  EXPECT_TRUE(android::base::EndsWith(source_output, kExpectedPmrSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenCompactTest) {
+  CppGenOptions options;
+  options.compact = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestCompactSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_NE(header_output.find("class EnumSet {"), std::string::npos);
+  EXPECT_NE(header_output.find("class PackedBoolList {"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedCompactHeaderOutput))
+      << header_output;
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedCompactSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenElideWritesTest) {
+  CppGenOptions options;
+  options.elide_writes = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestElideWritesSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_NE(source_output.find("bool SetRawValueIfChanged("),
+            std::string::npos);
+  EXPECT_TRUE(android::base::EndsWith(source_output,
+                                      kExpectedElideWritesSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenAsyncWritesTest) {
+  CppGenOptions options;
+  options.runtime = true;
+  options.async_writes = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestElideWritesSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedAsyncWritesHeaderOutput))
+      << header_output;
+  // Setters are internal, and so is SetAsync.
+  EXPECT_EQ(system_header_output.find("SetAsync"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(source_output, kExpectedAsyncWritesSourceOutput))
+      << source_output;
+}
+
+TEST(SyspropTest, CppGenAsyncWritesRequiresRuntime) {
+  TemporaryFile temp_file;
+  close(temp_file.fd);
+  temp_file.fd = -1;
+  ASSERT_TRUE(android::base::WriteStringToFile(kTestElideWritesSyspropFile,
+                                               temp_file.path));
+
+  TemporaryDir temp_dir;
+  CppGenOptions options;
+  options.async_writes = true;
+
+  std::string err;
+  EXPECT_FALSE(GenerateCppFiles(temp_file.path, temp_dir.path, temp_dir.path,
+                                temp_dir.path, "TestProperties.sysprop.h",
+                                options, &err));
+  EXPECT_EQ(err, "SetAsync requires the runtime library");
+}
+
+TEST(SyspropTest, CppGenTypedHandlesTest) {
+  CppGenOptions options;
+  options.typed_handles = true;
+
+  std::string header_output, system_header_output, source_output;
+  GenerateCppCode(kTestTypedHandlesSyspropFile, options, &header_output,
+                  &system_header_output, &source_output);
+
+  EXPECT_NE(header_output.find("struct Prop {"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(header_output, kExpectedTypedHandlesHeaderOutput))
+      << header_output;
+  EXPECT_TRUE(android::base::EndsWith(system_header_output,
+                                      kExpectedTypedHandlesSystemHeaderOutput))
+      << system_header_output;
+}
+
+TEST(SyspropTest, CppGenCApiTest) {
+  CppGenOptions options;
+  options.c_api = true;
+
+  std::string header_output, system_header_output, source_output,
+      c_header_output;
+  GenerateCppCode(kTestCApiSyspropFile, options, &header_output,
+                  &system_header_output, &source_output, &c_header_output);
+
+  EXPECT_NE(c_header_output.find("} sysprop_status_t;"), std::string::npos);
+  EXPECT_TRUE(
+      android::base::EndsWith(c_header_output, kExpectedCApiHeaderOutput))
+      << c_header_output;
+  EXPECT_NE(source_output.find(
+                "#include <properties/TestProperties.sysprop_c.h>\n"),
+            std::string::npos);
+  EXPECT_TRUE(android::base::EndsWith(source_output, kExpectedCApiSourceOutput))
+      << source_output;
 }
@@ -138,6 +138,34 @@ prop {
 }
 )";
 
+constexpr const char* kBootCachePolicyForReadWriteProperty =
+    R"(
+owner: Platform
+module: "android.os.BootProp"
+prop {
+    api_name: "bootprop"
+    type: Integer
+    scope: Internal
+    prop_name: "boot.prop"
+    access: ReadWrite
+    cache_policy: Boot
+}
+)";
+
+constexpr const char* kBootCachePolicyWithoutRoPrefix =
+    R"(
+owner: Platform
+module: "android.os.BootProp"
+prop {
+    api_name: "bootprop"
+    type: Integer
+    scope: Internal
+    prop_name: "boot.prop"
+    access: Readonly
+    cache_policy: Boot
+}
+)";
+
 /*
  * TODO: Some properties don't have prefix "ro." but not written in any
  * Java or C++ codes. They might be misnamed and should be readonly. Will
@@ -173,6 +201,11 @@ constexpr const char* kTestCasesAndExpectedErrors[][2] = {
      "\"ro.\""},
     {kIntegerAsBoolWithWrongType,
      "Prop \"long.prop\" has integer_as_bool: true, but not a boolean"},
+    {kBootCachePolicyForReadWriteProperty,
+     "Prop \"boot.prop\" has cache_policy: Boot, but is ReadWrite"},
+    {kBootCachePolicyWithoutRoPrefix,
+     "Prop \"boot.prop\" has cache_policy: Boot, but doesn't have prefix "
+     "\"ro.\""},
     /*    {kNoRoPrefixForReadonlyProperty,
          "Prop \"odm.i_am_readwrite\" isn't ReadWrite, but don't have prefix "
          "\"ro.\""},*/
@@ -18,6 +18,7 @@
 #include <string>
 
 #include <android-base/file.h>
+#include <android-base/strings.h>
 #include <android-base/test_utils.h>
 #include <gtest/gtest.h>
 
@@ -110,9 +111,14 @@ import android.annotation.SystemApi;
 
 import android.os.SystemProperties;
 import java.util.ArrayList;
+import java.util.BitSet;
 import java.util.function.Function;
 import java.util.List;
+import java.util.Locale;
 import java.util.Optional;
+import java.util.OptionalDouble;
+import java.util.OptionalInt;
+import java.util.OptionalLong;
 import java.util.StringJoiner;
 import java.util.stream.Collectors;
 
@@ -120,73 +126,150 @@ public final class TestProperties {
     private TestProperties () {}
 
     private static Boolean tryParseBoolean(String str) {
-        switch (str.toLowerCase()) {
-            case "1":
-            case "true":
-                return Boolean.TRUE;
-            case "0":
-            case "false":
-                return Boolean.FALSE;
+        return tryParseBoolean(str, 0, str.length());
+    }
+
+    // Parses str[begin, end) like Boolean.parseBoolean(str.toLowerCase(Locale.US)) would, but also
+    // takes "1" and "0", and returns null for anything else.
+    private static Boolean tryParseBoolean(String str, int begin, int end) {
+        switch (end - begin) {
+            case 1:
+                switch (str.charAt(begin)) {
+                    case '1':
+                        return Boolean.TRUE;
+                    case '0':
+                        return Boolean.FALSE;
+                    default:
+                        return null;
+                }
+            case 4:
+                return equalsLowerCase(str, begin, "true") ? Boolean.TRUE : null;
+            case 5:
+                return equalsLowerCase(str, begin, "false") ? Boolean.FALSE : null;
             default:
                 return null;
         }
     }
 
-    private static Integer tryParseInteger(String str) {
-        try {
-            return Integer.valueOf(str);
-        } catch (NumberFormatException e) {
-            return null;
+    // Whether str.substring(begin).toLowerCase(Locale.US) would start with |lower|, which is ASCII.
+    private static boolean equalsLowerCase(String str, int begin, String lower) {
+        for (int i = 0; i < lower.length(); ++i) {
+            if ((str.charAt(begin + i) | 0x20) != lower.charAt(i)) return false;
         }
+        return true;
     }
 
-    private static Long tryParseLong(String str) {
-        try {
-            return Long.valueOf(str);
-        } catch (NumberFormatException e) {
-            return null;
-        }
+    // Same as Integer.valueOf(str), with null in place of NumberFormatException.
+    private static Integer tryParseInteger(String str) {
+        long scanned = scanDecimal(str, 0, str.length(), Integer.MIN_VALUE, Integer.MAX_VALUE);
+        return scanned <= 0 ? Integer.valueOf((int) decimalValue(str, 0, scanned)) : null;
     }
 
-    private static Double tryParseDouble(String str) {
-        try {
-            return Double.valueOf(str);
-        } catch (NumberFormatException e) {
-            return null;
+    private static Long tryParseLong(String str) {
+        long scanned = scanDecimal(str, 0, str.length(), Long.MIN_VALUE, Long.MAX_VALUE);
+        return scanned <= 0 ? Long.valueOf(decimalValue(str, 0, scanned)) : null;
+    }
+
+    // Parses str[begin, end) like Long.parseLong(str.substring(begin, end)) would, and accepts
+    // values in [min, max]: an optional sign, then digits as told by Character.digit. Accumulates
+    // negatively like Long.parseLong, so that MIN_VALUE doesn't overflow, and returns the negated
+    // magnitude, which is never positive, or 1 if the string is rejected.
+    private static long scanDecimal(String str, int begin, int end, long min, long max) {
+        if (begin == end) return 1;
+        int i = begin;
+        boolean negative = false;
+        char first = str.charAt(begin);
+        if (first == '-' || first == '+') {
+            if (end - begin == 1) return 1;
+            negative = first == '-';
+            ++i;
         }
+        long limit = negative ? min : -max;
+        long multmin = limit / 10;
+        long result = 0;
+        for (; i < end; ++i) {
+            int digit = Character.digit(str.charAt(i), 10);
+            if (digit < 0 || result < multmin) return 1;
+            result *= 10;
+            if (result < limit + digit) return 1;
+            result -= digit;
+        }
+        return result;
     }
 
-    private static String tryParseString(String str) {
-        return "".equals(str) ? null : str;
+    // The value of str[begin, end), from what scanDecimal returned for it.
+    private static long decimalValue(String str, int begin, long scanned) {
+        return str.charAt(begin) == '-' ? scanned : -scanned;
     }
 
-    private static <T extends Enum<T>> T tryParseEnum(Class<T> enumType, String str) {
-        try {
-            return Enum.valueOf(enumType, str.toUpperCase());
-        } catch (IllegalArgumentException e) {
-            return null;
+    // Only strings which Double.valueOf(str) accepts are converted, so it never throws.
+    private static Double tryParseDouble(String str) {
+        return isDoubleString(str) ? Double.valueOf(str) : null;
+    }
+
+    // The grammar of Double.valueOf(str): surrounding characters up to ' ' are ignored, then an
+    // optional sign, and NaN, Infinity, a decimal number with an optional exponent, or a hex
+    // number with a binary exponent, the last two with an optional [fFdD] suffix.
+    private static boolean isDoubleString(String str) {
+        return isDoubleString(str, 0, str.length());
+    }
+
+    // Same as isDoubleString(str.substring(begin, end)).
+    private static boolean isDoubleString(String str, int begin, int end) {
+        int i = begin;
+        while (i < end && str.charAt(i) <= ' ') ++i;
+        while (end > i && str.charAt(end - 1) <= ' ') --end;
+        if (i < end && (str.charAt(i) == '+' || str.charAt(i) == '-')) ++i;
+        if (str.startsWith("NaN", i)) return i + 3 == end;
+        if (str.startsWith("Infinity", i)) return i + 8 == end;
+
+        boolean hex = end - i > 2 && str.charAt(i) == '0' && (str.charAt(i + 1) | 0x20) == 'x';
+        if (hex) i += 2;
+        int digitsEnd = skipDigits(str, i, end, hex);
+        int digits = digitsEnd - i;
+        i = digitsEnd;
+        if (i < end && str.charAt(i) == '.') {
+            digitsEnd = skipDigits(str, i + 1, end, hex);
+            digits += digitsEnd - i - 1;
+            i = digitsEnd;
         }
+        if (digits == 0) return false;
+
+        if (i < end && (str.charAt(i) | 0x20) == (hex ? 'p' : 'e')) {
+            ++i;
+            if (i < end && (str.charAt(i) == '+' || str.charAt(i) == '-')) ++i;
+            digitsEnd = skipDigits(str, i, end, false);
+            if (digitsEnd == i) return false;
+            i = digitsEnd;
+        } else if (hex) {
+            return false;
+        }
+        if (i < end && "fFdD".indexOf(str.charAt(i)) >= 0) ++i;
+        return i == end;
     }
 
-    private static <T> List<T> tryParseList(Function<String, T> elementParser, String str) {
-        if ("".equals(str)) return new ArrayList<>();
-
-        List<T> ret = new ArrayList<>();
-
-        for (String element : str.split(",")) {
-            ret.add(elementParser.apply(element));
+    // Unlike integers, Double.valueOf only takes ASCII digits.
+    private static int skipDigits(String str, int i, int end, boolean hex) {
+        while (i < end) {
+            char c = str.charAt(i);
+            int lower = c | 0x20;
+            if (!(c >= '0' && c <= '9') && !(hex && lower >= 'a' && lower <= 'f')) break;
+            ++i;
         }
+        return i;
+    }
 
-        return ret;
+    private static String tryParseString(String str) {
+        return "".equals(str) ? null : str;
     }
 
-    private static <T extends Enum<T>> List<T> tryParseEnumList(Class<T> enumType, String str) {
+    private static <T> List<T> tryParseList(Function<String, T> elementParser, String str) {
         if ("".equals(str)) return new ArrayList<>();
 
         List<T> ret = new ArrayList<>();
 
         for (String element : str.split(",")) {
-            ret.add(tryParseEnum(enumType, element));
+            ret.add(elementParser.apply(element));
         }
 
         return ret;
@@ -202,16 +285,6 @@ public final class TestProperties {
         return joiner.toString();
     }
 
-    private static <T extends Enum<T>> String formatEnumList(List<T> list, Function<T, String> elementFormatter) {
-        StringJoiner joiner = new StringJoiner(",");
-
-        for (T element : list) {
-            joiner.add(element == null ? "" : elementFormatter.apply(element));
-        }
-
-        return joiner.toString();
-    }
-
     /** @hide */
     public static Optional<Double> test_double() {
         String value = SystemProperties.get("vendor.test_double");
@@ -261,12 +334,34 @@ public final class TestProperties {
         public String getPropValue() {
             return propValue;
         }
+        private static test_enum_values tryParse(String str) {
+            switch (str) {
+                case "a": return A;
+                case "b": return B;
+                case "c": return C;
+                case "D": return D;
+                case "e": return E;
+                case "f": return F;
+                case "G": return G;
+                default: break;
+            }
+            switch (str.toUpperCase(Locale.US)) {
+                case "A": return A;
+                case "B": return B;
+                case "C": return C;
+                case "D": return D;
+                case "E": return E;
+                case "F": return F;
+                case "G": return G;
+                default: return null;
+            }
+        }
     }
 
     /** @hide */
     public static Optional<test_enum_values> test_enum() {
         String value = SystemProperties.get("vendor.test.enum");
-        return Optional.ofNullable(tryParseEnum(test_enum_values.class, value));
+        return Optional.ofNullable(test_enum_values.tryParse(value));
     }
 
     /** @hide */
@@ -341,17 +436,349 @@ public final class TestProperties {
         public String getPropValue() {
             return propValue;
         }
+        private static el_values tryParse(String str) {
+            switch (str) {
+                case "enu": return ENU;
+                case "mva": return MVA;
+                case "lue": return LUE;
+                default: break;
+            }
+            switch (str.toUpperCase(Locale.US)) {
+                case "ENU": return ENU;
+                case "MVA": return MVA;
+                case "LUE": return LUE;
+                default: return null;
+            }
+        }
+        private static String formatList(List<el_values> list) {
+            StringJoiner joiner = new StringJoiner(",");
+            for (el_values element : list) {
+                joiner.add(element == null ? "" : element.propValue);
+            }
+            return joiner.toString();
+        }
     }
 
     /** @hide */
     public static List<el_values> el() {
         String value = SystemProperties.get("vendor.el");
-        return tryParseEnumList(el_values.class, value);
+        return tryParseList(v -> el_values.tryParse(v), value);
     }
 
     /** @hide */
     public static void el(List<el_values> value) {
-        SystemProperties.set("vendor.el", value == null ? "" : formatEnumList(value, el_values::getPropValue));
+        SystemProperties.set("vendor.el", value == null ? "" : el_values.formatList(value));
+    }
+}
+)";
+
+constexpr const char* kTestCachePolicySyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.CachePolicyProperties"
+
+prop {
+    api_name: "boot_int"
+    type: Integer
+    scope: Internal
+    access: Readonly
+    cache_policy: Boot
+}
+prop {
+    api_name: "serial_strlist"
+    type: StringList
+    scope: Internal
+    access: ReadWrite
+    cache_policy: Serial
+}
+)";
+
+// Only the tail of the class, from the cache policy helpers on.
+constexpr const char* kExpectedCachePolicyJavaOutput =
+    R"(    private static final class CachedValue<T> {
+        final String propValue;
+        final T value;
+
+        CachedValue(String propValue, T value) {
+            this.propValue = propValue;
+            this.value = value;
+        }
+    }
+
+    private static volatile Optional<Integer> boot_int_value;
+
+    public static Optional<Integer> boot_int() {
+        Optional<Integer> ret = boot_int_value;
+        if (ret != null) return ret;
+        String value = SystemProperties.get("ro.boot_int");
+        ret = Optional.ofNullable(tryParseInteger(value));
+        if (!"".equals(value)) boot_int_value = ret;
+        return ret;
+    }
+
+    private static volatile CachedValue<List<String>> serial_strlist_cache;
+
+    public static List<String> serial_strlist() {
+        String value = SystemProperties.get("serial_strlist");
+        CachedValue<List<String>> cache = serial_strlist_cache;
+        if (cache == null || !cache.propValue.equals(value)) {
+            cache = new CachedValue<>(value, java.util.Collections.unmodifiableList(tryParseList(v -> tryParseString(v), value)));
+            serial_strlist_cache = cache;
+        }
+        return cache.value;
+    }
+
+    public static void serial_strlist(List<String> value) {
+        SystemProperties.set("serial_strlist", value == null ? "" : formatList(value));
+    }
+}
+)";
+
+constexpr const char* kTestPrimitiveGettersSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.PrimitiveProperties"
+
+prop {
+    api_name: "level"
+    type: Integer
+    scope: Public
+    access: ReadWrite
+}
+prop {
+    api_name: "uptime"
+    type: Long
+    scope: Internal
+    access: Readonly
+}
+prop {
+    api_name: "ratio"
+    type: Double
+    scope: Internal
+    access: Readonly
+    cache_policy: Serial
+}
+prop {
+    api_name: "enabled"
+    type: Boolean
+    scope: Internal
+    access: Readonly
+}
+)";
+
+// Only the tail of the class, from the first getter on.
+constexpr const char* kExpectedPrimitiveGettersJavaOutput =
+    R"(    public static Optional<Integer> level() {
+        String value = SystemProperties.get("level");
+        return Optional.ofNullable(tryParseInteger(value));
+    }
+
+    public static OptionalInt level_asOptionalInt() {
+        String value = SystemProperties.get("level");
+        long scanned = scanDecimal(value, 0, value.length(), Integer.MIN_VALUE, Integer.MAX_VALUE);
+        return scanned <= 0 ? OptionalInt.of((int) decimalValue(value, 0, scanned)) : OptionalInt.empty();
+    }
+
+    public static int level_orElse(int defaultValue) {
+        String value = SystemProperties.get("level");
+        long scanned = scanDecimal(value, 0, value.length(), Integer.MIN_VALUE, Integer.MAX_VALUE);
+        return scanned <= 0 ? (int) decimalValue(value, 0, scanned) : defaultValue;
+    }
+
+    /** @hide */
+    public static void level(Integer value) {
+        SystemProperties.set("level", value == null ? "" : value.toString());
+    }
+
+    /** @hide */
+    public static Optional<Long> uptime() {
+        String value = SystemProperties.get("ro.uptime");
+        return Optional.ofNullable(tryParseLong(value));
+    }
+
+    /** @hide */
+    public static OptionalLong uptime_asOptionalLong() {
+        String value = SystemProperties.get("ro.uptime");
+        long scanned = scanDecimal(value, 0, value.length(), Long.MIN_VALUE, Long.MAX_VALUE);
+        return scanned <= 0 ? OptionalLong.of(decimalValue(value, 0, scanned)) : OptionalLong.empty();
+    }
+
+    /** @hide */
+    public static long uptime_orElse(long defaultValue) {
+        String value = SystemProperties.get("ro.uptime");
+        long scanned = scanDecimal(value, 0, value.length(), Long.MIN_VALUE, Long.MAX_VALUE);
+        return scanned <= 0 ? decimalValue(value, 0, scanned) : defaultValue;
+    }
+
+    private static volatile CachedValue<Optional<Double>> ratio_cache;
+
+    /** @hide */
+    public static Optional<Double> ratio() {
+        String value = SystemProperties.get("ro.ratio");
+        CachedValue<Optional<Double>> cache = ratio_cache;
+        if (cache == null || !cache.propValue.equals(value)) {
+            cache = new CachedValue<>(value, Optional.ofNullable(tryParseDouble(value)));
+            ratio_cache = cache;
+        }
+        return cache.value;
+    }
+
+    /** @hide */
+    public static OptionalDouble ratio_asOptionalDouble() {
+        Optional<Double> ret = ratio();
+        return ret.isPresent() ? OptionalDouble.of(ret.get()) : OptionalDouble.empty();
+    }
+
+    /** @hide */
+    public static double ratio_orElse(double defaultValue) {
+        Optional<Double> ret = ratio();
+        return ret.isPresent() ? ret.get() : defaultValue;
+    }
+
+    /** @hide */
+    public static Optional<Boolean> enabled() {
+        String value = SystemProperties.get("ro.enabled");
+        return Optional.ofNullable(tryParseBoolean(value));
+    }
+
+    /** @hide */
+    public static boolean enabled_orElse(boolean defaultValue) {
+        String value = SystemProperties.get("ro.enabled");
+        Boolean ret = tryParseBoolean(value);
+        return ret != null ? ret : defaultValue;
+    }
+}
+)";
+
+constexpr const char* kTestPrimitiveArraysSyspropFile =
+    R"(owner: Platform
+module: "android.sysprop.ArrayProperties"
+
+prop {
+    api_name: "ids"
+    type: IntegerList
+    scope: Internal
+    access: ReadWrite
+}
+prop {
+    api_name: "weights"
+    type: DoubleList
+    scope: Public
+    access: Readonly
+}
+prop {
+    api_name: "names"
+    type: StringList
+    scope: Internal
+    access: Readonly
+}
+)";
+
+// Only the tail of the class, from the array parsers on.
+constexpr const char* kExpectedPrimitiveArraysJavaOutput =
+    R"(    // Number of elements of a list, as tryParseList splits it: String.split drops trailing empty
+    // elements.
+    private static int countElements(String str) {
+        int end = str.length();
+        while (end > 0 && str.charAt(end - 1) == ',') --end;
+        if (end == 0) return 0;
+        int count = 1;
+        for (int i = str.indexOf(','); i >= 0 && i < end; i = str.indexOf(',', i + 1)) ++count;
+        return count;
+    }
+
+    private static int elementEnd(String str, int begin) {
+        int end = str.indexOf(',', begin);
+        return end < 0 ? str.length() : end;
+    }
+
+    private static boolean[] parseBooleanArray(String str, BitSet present) {
+        boolean[] ret = new boolean[countElements(str)];
+        if (present != null) present.clear();
+        for (int i = 0, begin = 0; i < ret.length; ++i) {
+            int end = elementEnd(str, begin);
+            Boolean value = tryParseBoolean(str, begin, end);
+            if (value != null) {
+                ret[i] = value;
+                if (present != null) present.set(i);
+            }
+            begin = end + 1;
+        }
+        return ret;
+    }
+
+    private static int[] parseIntArray(String str, BitSet present) {
+        int[] ret = new int[countElements(str)];
+        if (present != null) present.clear();
+        for (int i = 0, begin = 0; i < ret.length; ++i) {
+            int end = elementEnd(str, begin);
+            long scanned = scanDecimal(str, begin, end, Integer.MIN_VALUE, Integer.MAX_VALUE);
+            if (scanned <= 0) {
+                ret[i] = (int) decimalValue(str, begin, scanned);
+                if (present != null) present.set(i);
+            }
+            begin = end + 1;
+        }
+        return ret;
+    }
+
+    private static long[] parseLongArray(String str, BitSet present) {
+        long[] ret = new long[countElements(str)];
+        if (present != null) present.clear();
+        for (int i = 0, begin = 0; i < ret.length; ++i) {
+            int end = elementEnd(str, begin);
+            long scanned = scanDecimal(str, begin, end, Long.MIN_VALUE, Long.MAX_VALUE);
+            if (scanned <= 0) {
+                ret[i] = decimalValue(str, begin, scanned);
+                if (present != null) present.set(i);
+            }
+            begin = end + 1;
+        }
+        return ret;
+    }
+
+    // Only valid elements are copied out for Double.parseDouble.
+    private static double[] parseDoubleArray(String str, BitSet present) {
+        double[] ret = new double[countElements(str)];
+        if (present != null) present.clear();
+        for (int i = 0, begin = 0; i < ret.length; ++i) {
+            int end = elementEnd(str, begin);
+            if (isDoubleString(str, begin, end)) {
+                ret[i] = Double.parseDouble(str.substring(begin, end));
+                if (present != null) present.set(i);
+            }
+            begin = end + 1;
+        }
+        return ret;
+    }
+
+    /** @hide */
+    public static List<Integer> ids() {
+        String value = SystemProperties.get("ids");
+        return tryParseList(v -> tryParseInteger(v), value);
+    }
+
+    /** @hide */
+    public static int[] ids_asArray(BitSet present) {
+        return parseIntArray(SystemProperties.get("ids"), present);
+    }
+
+    /** @hide */
+    public static void ids(List<Integer> value) {
+        SystemProperties.set("ids", value == null ? "" : formatList(value));
+    }
+
+    public static List<Double> weights() {
+        String value = SystemProperties.get("ro.weights");
+        return tryParseList(v -> tryParseDouble(v), value);
+    }
+
+    public static double[] weights_asArray(BitSet present) {
+        return parseDoubleArray(SystemProperties.get("ro.weights"), present);
+    }
+
+    /** @hide */
+    public static List<String> names() {
+        String value = SystemProperties.get("ro.names");
+        return tryParseList(v -> tryParseString(v), value);
     }
 }
 )";
@@ -372,7 +799,8 @@ TEST(SyspropTest, JavaGenTest) {
   TemporaryDir temp_dir;
 
   std::string err;
-  ASSERT_TRUE(GenerateJavaLibrary(temp_file.path, temp_dir.path, &err));
+  ASSERT_TRUE(GenerateJavaLibrary(temp_file.path, temp_dir.path,
+                                  JavaGenOptions(), &err));
   ASSERT_TRUE(err.empty());
 
   std::string java_output_path =
@@ -387,3 +815,96 @@ TEST(SyspropTest, JavaGenTest) {
   rmdir((temp_dir.path + "/com/somecompany"s).c_str());
   rmdir((temp_dir.path + "/com"s).c_str());
 }
+
+TEST(SyspropTest, JavaGenCachePolicyTest) {
+  TemporaryFile temp_file;
+  ASSERT_TRUE(android::base::WriteStringToFile(kTestCachePolicySyspropFile,
+                                               temp_file.path));
+  close(temp_file.fd);
+  temp_file.fd = -1;
+
+  TemporaryDir temp_dir;
+
+  std::string err;
+  ASSERT_TRUE(GenerateJavaLibrary(temp_file.path, temp_dir.path,
+                                  JavaGenOptions(), &err));
+  ASSERT_TRUE(err.empty());
+
+  std::string java_output_path =
+      temp_dir.path + "/android/sysprop/CachePolicyProperties.java"s;
+
+  std::string java_output;
+  ASSERT_TRUE(
+      android::base::ReadFileToString(java_output_path, &java_output, true));
+  EXPECT_TRUE(
+      android::base::EndsWith(java_output, kExpectedCachePolicyJavaOutput))
+      << java_output;
+
+  unlink(java_output_path.c_str());
+  rmdir((temp_dir.path + "/android/sysprop"s).c_str());
+  rmdir((temp_dir.path + "/android"s).c_str());
+}
+
+TEST(SyspropTest, JavaGenPrimitiveGettersTest) {
+  TemporaryFile temp_file;
+  ASSERT_TRUE(android::base::WriteStringToFile(
+      kTestPrimitiveGettersSyspropFile, temp_file.path));
+  close(temp_file.fd);
+  temp_file.fd = -1;
+
+  TemporaryDir temp_dir;
+
+  JavaGenOptions options;
+  options.primitive_getters = true;
+
+  std::string err;
+  ASSERT_TRUE(
+      GenerateJavaLibrary(temp_file.path, temp_dir.path, options, &err));
+  ASSERT_TRUE(err.empty());
+
+  std::string java_output_path =
+      temp_dir.path + "/android/sysprop/PrimitiveProperties.java"s;
+
+  std::string java_output;
+  ASSERT_TRUE(
+      android::base::ReadFileToString(java_output_path, &java_output, true));
+  EXPECT_TRUE(android::base::EndsWith(java_output,
+                                      kExpectedPrimitiveGettersJavaOutput))
+      << java_output;
+
+  unlink(java_output_path.c_str());
+  rmdir((temp_dir.path + "/android/sysprop"s).c_str());
+  rmdir((temp_dir.path + "/android"s).c_str());
+}
+
+TEST(SyspropTest, JavaGenPrimitiveArraysTest) {
+  TemporaryFile temp_file;
+  ASSERT_TRUE(android::base::WriteStringToFile(kTestPrimitiveArraysSyspropFile,
+                                               temp_file.path));
+  close(temp_file.fd);
+  temp_file.fd = -1;
+
+  TemporaryDir temp_dir;
+
+  JavaGenOptions options;
+  options.primitive_arrays = true;
+
+  std::string err;
+  ASSERT_TRUE(
+      GenerateJavaLibrary(temp_file.path, temp_dir.path, options, &err));
+  ASSERT_TRUE(err.empty());
+
+  std::string java_output_path =
+      temp_dir.path + "/android/sysprop/ArrayProperties.java"s;
+
+  std::string java_output;
+  ASSERT_TRUE(
+      android::base::ReadFileToString(java_output_path, &java_output, true));
+  EXPECT_TRUE(android::base::EndsWith(java_output,
+                                      kExpectedPrimitiveArraysJavaOutput))
+      << java_output;
+
+  unlink(java_output_path.c_str());
+  rmdir((temp_dir.path + "/android/sysprop"s).c_str());
+  rmdir((temp_dir.path + "/android"s).c_str());
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FakeSystemProperties.h"
+
+#include <sys/system_properties.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Like in bionic, a prop_info is never freed once it has been added.
+struct prop_info {
+  std::string name;
+  std::string value;
+  std::atomic<uint32_t> serial{0};
+};
+
+namespace {
+
+// Leaked, since threads waiting on properties may outlive static destructors.
+std::mutex& g_lock = *new std::mutex;
+std::condition_variable& g_changed = *new std::condition_variable;
+std::atomic<uint32_t> g_area_serial{0};
+std::atomic<bool> g_area_serial_overridden{false};
+std::atomic<uint32_t> g_area_serial_override{0};
+std::atomic<uint64_t> g_find_count{0};
+std::atomic<uint64_t> g_read_count{0};
+std::atomic<uint64_t> g_set_count{0};
+std::atomic<uint64_t> g_set_call_count{0};
+std::mutex& g_set_gate = *new std::mutex;
+
+// std::less<> allows lookups by const char* without a temporary std::string,
+// so that reading a property doesn't allocate.
+using PropertyMap =
+    std::map<std::string, std::unique_ptr<prop_info>, std::less<>>;
+
+PropertyMap& Properties() {
+  static auto* properties = new PropertyMap();
+  return *properties;
+}
+
+}  // namespace
+
+std::optional<std::string> GetFakeProperty(const std::string& name) {
+  std::lock_guard<std::mutex> lock(g_lock);
+  auto it = Properties().find(name);
+  if (it == Properties().end()) return std::nullopt;
+  return it->second->value;
+}
+
+std::uint64_t GetFakeReadCount() {
+  return g_read_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t GetFakeFindCount() {
+  return g_find_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t GetFakeSetCount() {
+  return g_set_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t GetFakeSetCallCount() {
+  return g_set_call_count.load(std::memory_order_relaxed);
+}
+
+ScopedBlockFakeSets::ScopedBlockFakeSets() { g_set_gate.lock(); }
+
+ScopedBlockFakeSets::~ScopedBlockFakeSets() { g_set_gate.unlock(); }
+
+ScopedFakeAreaSerial::ScopedFakeAreaSerial(std::uint32_t serial) {
+  g_area_serial_override.store(serial, std::memory_order_relaxed);
+  g_area_serial_overridden.store(true, std::memory_order_release);
+}
+
+ScopedFakeAreaSerial::~ScopedFakeAreaSerial() {
+  g_area_serial_overridden.store(false, std::memory_order_release);
+}
+
+extern "C" {
+
+int __system_property_set(const char* key, const char* value) {
+  g_set_call_count.fetch_add(1, std::memory_order_relaxed);
+  bool read_only = std::strncmp(key, "ro.", 3) == 0;
+  if (!read_only && std::strlen(value) >= PROP_VALUE_MAX) return -1;
+
+  { std::lock_guard<std::mutex> gate(g_set_gate); }
+  std::lock_guard<std::mutex> lock(g_lock);
+  auto it = Properties().find(key);
+  if (it == Properties().end()) {
+    it = Properties().emplace(key, std::make_unique<prop_info>()).first;
+    it->second->name = key;
+  } else if (read_only) {
+    return -1;
+  }
+  prop_info* pi = it->second.get();
+  pi->value = value;
+  pi->serial.fetch_add(1, std::memory_order_release);
+  g_set_count.fetch_add(1, std::memory_order_relaxed);
+  g_area_serial.fetch_add(1, std::memory_order_release);
+  g_changed.notify_all();
+  return 0;
+}
+
+const prop_info* __system_property_find(const char* name) {
+  g_find_count.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(g_lock);
+  auto it = Properties().find(name);
+  return it == Properties().end() ? nullptr : it->second.get();
+}
+
+void __system_property_read_callback(
+    const prop_info* pi,
+    void (*callback)(void* cookie, const char* name, const char* value,
+                     uint32_t serial),
+    void* cookie) {
+  g_read_count.fetch_add(1, std::memory_order_relaxed);
+
+  // Like bionic, "ro." values are handed out in place since they never change
+  // and mutable ones are copied to the stack first.
+  if (std::strncmp(pi->name.c_str(), "ro.", 3) == 0) {
+    callback(cookie, pi->name.c_str(), pi->value.c_str(),
+             pi->serial.load(std::memory_order_acquire));
+    return;
+  }
+
+  char value[PROP_VALUE_MAX];
+  uint32_t serial;
+  {
+    std::lock_guard<std::mutex> lock(g_lock);
+    std::strcpy(value, pi->value.c_str());
+    serial = pi->serial.load(std::memory_order_relaxed);
+  }
+  callback(cookie, pi->name.c_str(), value, serial);
+}
+
+int __system_property_foreach(void (*propfn)(const prop_info* pi, void* cookie),
+                              void* cookie) {
+  std::lock_guard<std::mutex> lock(g_lock);
+  for (const auto& [name, pi] : Properties()) {
+    propfn(pi.get(), cookie);
+  }
+  return 0;
+}
+
+bool __system_property_wait(const prop_info* pi, uint32_t old_serial,
+                            uint32_t* new_serial_ptr,
+                            const struct timespec* relative_timeout) {
+  auto current_serial = [pi] {
+    return pi != nullptr ? pi->serial.load(std::memory_order_acquire)
+                         : g_area_serial.load(std::memory_order_acquire);
+  };
+  auto changed = [&] { return current_serial() != old_serial; };
+
+  std::unique_lock<std::mutex> lock(g_lock);
+  if (relative_timeout == nullptr) {
+    g_changed.wait(lock, changed);
+  } else {
+    auto timeout = std::chrono::seconds(relative_timeout->tv_sec) +
+                   std::chrono::nanoseconds(relative_timeout->tv_nsec);
+    if (!g_changed.wait_for(lock, timeout, changed)) return false;
+  }
+  if (new_serial_ptr != nullptr) *new_serial_ptr = current_serial();
+  return true;
+}
+
+uint32_t __system_property_serial(const prop_info* pi) {
+  return pi->serial.load(std::memory_order_acquire);
+}
+
+uint32_t __system_property_area_serial() {
+  if (g_area_serial_overridden.load(std::memory_order_acquire)) {
+    return g_area_serial_override.load(std::memory_order_relaxed);
+  }
+  return g_area_serial.load(std::memory_order_acquire);
+}
+
+}  // extern "C"
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYSTEM_PROPERTIES_H_
+#define SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYSTEM_PROPERTIES_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Returns the raw value of |name| in the fake property area, or std::nullopt
+// if it has never been set.
+std::optional<std::string> GetFakeProperty(const std::string& name);
+
+// Returns how many times __system_property_read_callback() has been called.
+std::uint64_t GetFakeReadCount();
+
+// Returns how many times __system_property_find() has been called.
+std::uint64_t GetFakeFindCount();
+
+// Returns how many times __system_property_set() has changed a property.
+std::uint64_t GetFakeSetCount();
+
+// Returns how many times __system_property_set() has been called, including
+// the calls which it rejected.
+std::uint64_t GetFakeSetCallCount();
+
+// Holds back every call to __system_property_set() while it exists, so that
+// tests can keep writes queued.
+class ScopedBlockFakeSets {
+ public:
+  ScopedBlockFakeSets();
+  ~ScopedBlockFakeSets();
+  ScopedBlockFakeSets(const ScopedBlockFakeSets&) = delete;
+  ScopedBlockFakeSets& operator=(const ScopedBlockFakeSets&) = delete;
+};
+
+// Makes __system_property_area_serial() return |serial| while it exists, as
+// if the area serial had wrapped around to it.
+class ScopedFakeAreaSerial {
+ public:
+  explicit ScopedFakeAreaSerial(std::uint32_t serial);
+  ~ScopedFakeAreaSerial();
+  ScopedFakeAreaSerial(const ScopedFakeAreaSerial&) = delete;
+  ScopedFakeAreaSerial& operator=(const ScopedFakeAreaSerial&) = delete;
+};
+
+#endif  // SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYSTEM_PROPERTIES_H_
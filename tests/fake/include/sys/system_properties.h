@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host stand-in for bionic's <sys/system_properties.h>, so that generated
+// code can be built and run by host tests. The functions are implemented by
+// FakeSystemProperties.cpp on top of an in-process property area.
+
+#ifndef SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYS_SYSTEM_PROPERTIES_H_
+#define SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYS_SYSTEM_PROPERTIES_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#define PROP_VALUE_MAX 92
+
+typedef struct prop_info prop_info;
+
+extern "C" {
+
+int __system_property_set(const char* key, const char* value);
+const prop_info* __system_property_find(const char* name);
+void __system_property_read_callback(
+    const prop_info* pi,
+    void (*callback)(void* cookie, const char* name, const char* value,
+                     uint32_t serial),
+    void* cookie);
+int __system_property_foreach(void (*propfn)(const prop_info* pi, void* cookie),
+                              void* cookie);
+bool __system_property_wait(const prop_info* pi, uint32_t old_serial,
+                            uint32_t* new_serial_ptr,
+                            const struct timespec* relative_timeout);
+uint32_t __system_property_serial(const prop_info* pi);
+uint32_t __system_property_area_serial();
+
+}  // extern "C"
+
+#endif  // SYSTEM_TOOLS_SYSPROP_TESTS_FAKE_SYS_SYSTEM_PROPERTIES_H_
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_TOOLS_SYSPROP_TESTS_ALLOCATION_COUNTER_H_
+#define SYSTEM_TOOLS_SYSPROP_TESTS_ALLOCATION_COUNTER_H_
+
+// Counts calls to the global operator new made by the current thread while
+// an instance is alive.
+class ScopedAllocationCounter {
+ public:
+  ScopedAllocationCounter();
+  ~ScopedAllocationCounter();
+
+  int count() const {
+    return count_;
+  }
+
+ private:
+  ScopedAllocationCounter(const ScopedAllocationCounter&) = delete;
+  ScopedAllocationCounter& operator=(const ScopedAllocationCounter&) = delete;
+
+  int count_ = 0;
+  int* previous_;
+};
+
+#endif  // SYSTEM_TOOLS_SYSPROP_TESTS_ALLOCATION_COUNTER_H_
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Built as C, so that the generated C header is checked to be valid C.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TestProperties.sysprop_c.h"
+
+bool CApiSetAndGetInts(void) {
+  const int32_t values[] = {1, 0, 3};
+  const bool present[] = {true, false, true};
+  if (android_sysprop_TestProperties_ints_set(values, present, 3) !=
+      SYSPROP_OK) {
+    return false;
+  }
+
+  int32_t got[4];
+  bool got_present[4];
+  size_t size = 4;
+  if (android_sysprop_TestProperties_ints_get(got, got_present, &size) !=
+      SYSPROP_OK) {
+    return false;
+  }
+  return size == 3 && got_present[0] && got[0] == 1 && !got_present[1] &&
+         got_present[2] && got[2] == 3;
+}
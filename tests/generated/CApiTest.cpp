@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+#include "TestProperties.sysprop_c.h"
+
+// Defined in CApiCheck.c.
+extern "C" bool CApiSetAndGetInts(void);
+
+TEST(SyspropGeneratedTest, CApiSetsAndGetsScalars) {
+  bool ready = true;
+  ASSERT_EQ(android_sysprop_TestProperties_ready_set(&ready), SYSPROP_OK);
+  EXPECT_EQ(GetFakeProperty("ready"), "true");
+  ready = false;
+  EXPECT_EQ(android_sysprop_TestProperties_ready_get(&ready), SYSPROP_OK);
+  EXPECT_TRUE(ready);
+
+  ASSERT_EQ(android_sysprop_TestProperties_ready_set(nullptr), SYSPROP_OK);
+  EXPECT_EQ(android_sysprop_TestProperties_ready_get(&ready), SYSPROP_MISSING);
+
+  ASSERT_EQ(__system_property_set("ready", "maybe"), 0);
+  EXPECT_EQ(android_sysprop_TestProperties_ready_get(&ready), SYSPROP_INVALID);
+
+  auto letter = android_sysprop_TestProperties_letter_E_E;
+  ASSERT_EQ(android_sysprop_TestProperties_letter_set(&letter), SYSPROP_OK);
+  EXPECT_EQ(GetFakeProperty("letter"), "e_e");
+  EXPECT_EQ(android::sysprop::TestProperties::letter(),
+            android::sysprop::TestProperties::letter_values::E_E);
+  ASSERT_EQ(__system_property_set("letter", "abd"), 0);
+  EXPECT_EQ(android_sysprop_TestProperties_letter_get(&letter), SYSPROP_OK);
+  EXPECT_EQ(letter, android_sysprop_TestProperties_letter_ABD);
+}
+
+TEST(SyspropGeneratedTest, CApiReportsSizeOfList) {
+  ASSERT_EQ(__system_property_set("doubles", "1.5,,x,4"), 0);
+
+  double values[2];
+  bool present[2];
+  std::size_t size = 2;
+  EXPECT_EQ(
+      android_sysprop_TestProperties_doubles_get(values, present, &size),
+      SYSPROP_TOO_SMALL);
+  EXPECT_EQ(size, 4u);
+  EXPECT_TRUE(present[0]);
+  EXPECT_EQ(values[0], 1.5);
+  EXPECT_FALSE(present[1]);
+
+  double all_values[4];
+  bool all_present[4];
+  EXPECT_EQ(android_sysprop_TestProperties_doubles_get(all_values, all_present,
+                                                       &size),
+            SYSPROP_OK);
+  EXPECT_FALSE(all_present[2]);
+  EXPECT_EQ(all_values[3], 4.0);
+
+  const android_sysprop_TestProperties_letters_values letters[] = {
+      android_sysprop_TestProperties_letters_B,
+      android_sysprop_TestProperties_letters__X,
+  };
+  ASSERT_EQ(android_sysprop_TestProperties_letters_set(letters, nullptr, 2),
+            SYSPROP_OK);
+  EXPECT_EQ(GetFakeProperty("letters"), "b,_x");
+
+  EXPECT_TRUE(CApiSetAndGetInts());
+  EXPECT_EQ(GetFakeProperty("ints"), "1,,3");
+}
+
+TEST(SyspropGeneratedTest, CApiCopiesStrings) {
+  ASSERT_EQ(android_sysprop_TestProperties_serial_string_set("hello"),
+            SYSPROP_OK);
+
+  char buf[6];
+  std::size_t size = 3;
+  EXPECT_EQ(android_sysprop_TestProperties_serial_string_get(buf, &size),
+            SYSPROP_TOO_SMALL);
+  EXPECT_EQ(size, 6u);
+  EXPECT_EQ(android_sysprop_TestProperties_serial_string_get(buf, &size),
+            SYSPROP_OK);
+  EXPECT_STREQ(buf, "hello");
+
+  std::string too_long(PROP_VALUE_MAX, 'x');
+  EXPECT_EQ(android_sysprop_TestProperties_serial_string_set(too_long.c_str()),
+            SYSPROP_TOO_LONG);
+  EXPECT_EQ(GetFakeProperty("serial_string"), "hello");
+}
+
+TEST(SyspropGeneratedTest, CApiCopiesStringLists) {
+  const char* const values[] = {"a", nullptr, "bc"};
+  ASSERT_EQ(android_sysprop_TestProperties_strings_set(values, 3), SYSPROP_OK);
+  EXPECT_EQ(GetFakeProperty("strings"), "a,,bc");
+
+  char buf[5];
+  const char* items[3];
+  std::size_t buf_size = 4;
+  std::size_t size = 3;
+  EXPECT_EQ(android_sysprop_TestProperties_strings_get(buf, &buf_size, items,
+                                                       &size),
+            SYSPROP_TOO_SMALL);
+  EXPECT_EQ(buf_size, 5u);
+  EXPECT_EQ(size, 3u);
+
+  EXPECT_EQ(android_sysprop_TestProperties_strings_get(buf, &buf_size, items,
+                                                       &size),
+            SYSPROP_OK);
+  EXPECT_STREQ(items[0], "a");
+  EXPECT_EQ(items[1], nullptr);
+  EXPECT_STREQ(items[2], "bc");
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, BootValueIsParsedOnceSet) {
+  EXPECT_TRUE(boot_ints().empty());
+
+  ASSERT_TRUE(boot_ints({1, std::nullopt, 3}));
+  const IntList& value = boot_ints();
+  EXPECT_EQ(value, (IntList{1, std::nullopt, 3}));
+  EXPECT_EQ(&boot_ints(), &value);
+}
+
+TEST(SyspropGeneratedTest, SerialValueFollowsChanges) {
+  ASSERT_TRUE(serial_string("first"));
+  EXPECT_EQ(serial_string(), "first");
+  EXPECT_EQ(serial_string(), "first");
+
+  ASSERT_TRUE(serial_string("second"));
+  EXPECT_EQ(serial_string(), "second");
+
+  ASSERT_TRUE(serial_string(std::nullopt));
+  EXPECT_EQ(serial_string(), std::nullopt);
+}
+
+TEST(SyspropGeneratedTest, SerialValueIsSharedByThreads) {
+  ASSERT_TRUE(serial_string("shared"));
+  EXPECT_EQ(serial_string(), "shared");
+
+  std::uint64_t reads = GetFakeReadCount();
+  std::thread([] { EXPECT_EQ(serial_string(), "shared"); }).join();
+  EXPECT_EQ(GetFakeReadCount(), reads);
+}
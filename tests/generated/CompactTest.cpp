@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+static_assert(sizeof(letters_values) == 1);
+static_assert(std::is_same_v<std::underlying_type_t<letters_values>,
+                             std::uint8_t>);
+
+TEST(SyspropGeneratedTest, EnumSetHoldsNamesOfList) {
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9,zz,a"), 0);
+  auto set = letters_Set();
+  EXPECT_EQ(set.size(), 3u);
+  EXPECT_TRUE(set.contains(letters_values::A));
+  EXPECT_TRUE(set.contains(letters_values::ABD));
+  EXPECT_TRUE(set.contains(letters_values::X9));
+  EXPECT_FALSE(set.contains(letters_values::B));
+
+  ASSERT_EQ(__system_property_set("letters", ""), 0);
+  EXPECT_TRUE(letters_Set().empty());
+}
+
+TEST(SyspropGeneratedTest, PackedBoolListMatchesVector) {
+  ASSERT_EQ(__system_property_set("bools", "1,true,0,,yes,FALSE"), 0);
+  auto packed = bools_Packed();
+  std::vector<std::optional<bool>> expected = bools();
+  ASSERT_EQ(packed.size(), expected.size());
+  for (std::size_t i = 0; i < packed.size(); ++i) {
+    EXPECT_EQ(packed[i], expected[i]) << i;
+  }
+}
+
+TEST(SyspropGeneratedTest, CompactReadsDoNotAllocate) {
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9,zz,bcd,e_e"), 0);
+  ASSERT_EQ(__system_property_set("bools", "true,0,,1,false,true,1,0"), 0);
+
+  // Resolve the handles first.
+  letters_Set();
+  bools_Packed();
+
+  ScopedAllocationCounter counter;
+  EXPECT_EQ(letters_Set().size(), 5u);
+  EXPECT_EQ(bools_Packed().size(), 8u);
+  EXPECT_EQ(counter.count(), 0);
+}
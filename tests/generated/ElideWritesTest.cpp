@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+// Every call to __system_property_set() bumps the serial in the fake, even
+// when the value doesn't change.
+std::uint32_t SerialOf(const char* name) {
+  const prop_info* pi = __system_property_find(name);
+  return pi != nullptr ? __system_property_serial(pi) : 0;
+}
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, SetSkipsUnchangedValue) {
+  ASSERT_TRUE(ints({1, std::nullopt, 2}));
+  std::uint32_t serial = SerialOf("ints");
+
+  EXPECT_TRUE(ints({1, std::nullopt, 2}));
+  EXPECT_EQ(SerialOf("ints"), serial);
+
+  EXPECT_TRUE(ints({1, 2}));
+  EXPECT_NE(SerialOf("ints"), serial);
+  EXPECT_EQ(GetFakeProperty("ints"), "1,2");
+}
+
+TEST(SyspropGeneratedTest, SetSkipsUnchangedEnum) {
+  ASSERT_TRUE(letter(letter_values::ABC));
+  std::uint32_t serial = SerialOf("letter");
+
+  EXPECT_TRUE(letter(letter_values::ABC));
+  EXPECT_EQ(SerialOf("letter"), serial);
+
+  EXPECT_TRUE(letter(letter_values::D));
+  EXPECT_NE(SerialOf("letter"), serial);
+}
+
+TEST(SyspropGeneratedTest, SetStoresValueInCache) {
+  ASSERT_TRUE(serial_string("written"));
+  std::uint64_t reads = GetFakeReadCount();
+  EXPECT_EQ(serial_string(), "written");
+  EXPECT_EQ(GetFakeReadCount(), reads);
+
+  // Values set from elsewhere are still picked up.
+  ASSERT_EQ(__system_property_set("serial_string", "external"), 0);
+  EXPECT_EQ(serial_string(), "external");
+
+  ASSERT_TRUE(serial_string(std::nullopt));
+  reads = GetFakeReadCount();
+  EXPECT_EQ(serial_string(), std::nullopt);
+  EXPECT_EQ(GetFakeReadCount(), reads);
+
+  // The cache holds what readers parse from the property, which isn't always
+  // what was passed to the setter.
+  ASSERT_TRUE(serial_string(std::optional<std::string>("")));
+  EXPECT_EQ(serial_string(), std::nullopt);
+
+  ASSERT_TRUE(serial_strings({"a", "b"}));
+  ASSERT_TRUE(serial_strings({}));
+  EXPECT_EQ(GetFakeProperty("serial_strings"), "");
+  EXPECT_EQ(serial_strings(),
+            std::vector<std::optional<std::string>>({std::nullopt}));
+
+  ASSERT_TRUE(serial_strings({"a,b"}));
+  EXPECT_EQ(GetFakeProperty("serial_strings"), "a,b");
+  EXPECT_EQ(serial_strings(),
+            std::vector<std::optional<std::string>>({"a", "b"}));
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <android-base/strings.h>
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+// Must match enum_values of "letter" and "letters" in TestProperties.sysprop.
+constexpr const char* kLetterNames[] = {
+    "a", "b", "ab", "ac", "abc", "abd", "acb",
+    "bcd", "D", "d1", "e_e", "e_f", "_x", "X9",
+};
+
+constexpr const char* kInputs[] = {
+    "",    "a",   "A",    "b",   "ab",  "aB",  "Ab",  "ac",   "abc",
+    "ABC", "abd", "abe",  "acb", "bcd", "bc",  "bcde", "D",   "d",
+    "d1",  "D1",  "e_e",  "e_f", "e_g", "E_E", "_x",  "_X",   "X9",
+    "x9",  "9",   "abcd", " a",  "a ",  "_",   "e",   "acbd",
+};
+
+// The linear scan which generated DoParse specializations used to do.
+template <typename E>
+std::optional<E> LinearParse(const char* str) {
+  for (std::size_t i = 0; i < std::size(kLetterNames); ++i) {
+    if (std::strcmp(str, kLetterNames[i]) == 0) return static_cast<E>(i);
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, EnumParseMatchesLinearScan) {
+  for (const char* input : kInputs) {
+    ASSERT_EQ(__system_property_set("letter", input), 0);
+    EXPECT_EQ(letter(), LinearParse<letter_values>(input))
+        << "input: \"" << input << "\"";
+  }
+}
+
+TEST(SyspropGeneratedTest, EnumFormatMatchesNames) {
+  for (std::size_t i = 0; i < std::size(kLetterNames); ++i) {
+    ASSERT_TRUE(letter(static_cast<letter_values>(i)));
+    EXPECT_EQ(GetFakeProperty("letter"), kLetterNames[i]);
+  }
+
+  ASSERT_TRUE(letter(std::nullopt));
+  EXPECT_EQ(GetFakeProperty("letter"), "");
+}
+
+TEST(SyspropGeneratedTest, EnumListParseMatchesLinearScan) {
+  // Non-"ro." values must fit in PROP_VALUE_MAX, so only a part of kInputs.
+  std::vector<std::string> inputs = {
+      "a", "", "A", "ab", "aB", "abd", "abe", "acb", "bcd", "D",
+      "d", "d1", "e_f", "_x", "X9", "x9", "abcd", " a",
+  };
+  std::string value = android::base::Join(inputs, ",");
+
+  ASSERT_EQ(__system_property_set("letters", value.c_str()), 0);
+  std::vector<std::optional<letters_values>> parsed = letters();
+
+  ASSERT_EQ(parsed.size(), inputs.size());
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(parsed[i], LinearParse<letters_values>(inputs[i].c_str()))
+        << "input: \"" << inputs[i] << "\"";
+  }
+}
+
+TEST(SyspropGeneratedTest, EnumListFormatMatchesNames) {
+  std::vector<std::optional<letters_values>> value;
+  std::vector<std::string> expected;
+  for (std::size_t i = 0; i < std::size(kLetterNames); ++i) {
+    value.emplace_back(static_cast<letters_values>(i));
+    expected.emplace_back(kLetterNames[i]);
+  }
+  value.emplace_back(std::nullopt);
+  expected.emplace_back("");
+
+  ASSERT_TRUE(letters(value));
+  EXPECT_EQ(GetFakeProperty("letters"), android::base::Join(expected, ","));
+}
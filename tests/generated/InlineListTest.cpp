@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+template <typename List>
+auto ToVector(const List& list) {
+  return std::vector(list.begin(), list.end());
+}
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, InlineListsMatchVectors) {
+  ASSERT_EQ(__system_property_set("ints", "1,,-3, 4,x,2147483648,0x10,"), 0);
+  ASSERT_EQ(__system_property_set("bools", "1,true,0,,yes"), 0);
+  ASSERT_EQ(__system_property_set("doubles", "1.5,-2e3,,inf"), 0);
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9,zz"), 0);
+
+  EXPECT_EQ(ToVector(ints_Inline()), ints());
+  EXPECT_EQ(ToVector(bools_Inline()), bools());
+  EXPECT_EQ(ToVector(doubles_Inline()), doubles());
+  EXPECT_EQ(ToVector(letters_Inline()), letters());
+}
+
+TEST(SyspropGeneratedTest, InlineListOfLongestValue) {
+  std::string value(PROP_VALUE_MAX - 1, ',');
+  ASSERT_EQ(__system_property_set("ints", value.c_str()), 0);
+  auto list = ints_Inline();
+  EXPECT_EQ(list.size(), static_cast<std::size_t>(PROP_VALUE_MAX));
+  EXPECT_LE(list.size(), list.capacity());
+}
+
+TEST(SyspropGeneratedTest, InlineStringListOwnsCharacters) {
+  ASSERT_EQ(__system_property_set("strings", "abc,,de"), 0);
+  auto list = std::make_optional(strings_Inline());
+  ASSERT_EQ(__system_property_set("strings", "xyz"), 0);
+
+  // Copies point into their own storage.
+  InlineStringList copy = *list;
+  list.reset();
+  std::vector<std::optional<std::string_view>> expected = {
+      "abc", std::nullopt, "de"};
+  EXPECT_EQ(ToVector(copy), expected);
+  for (const auto& element : copy) {
+    if (!element) continue;
+    auto begin = reinterpret_cast<const char*>(&copy);
+    EXPECT_GE(element->data(), begin);
+    EXPECT_LE(element->data() + element->size(), begin + sizeof(copy));
+  }
+}
+
+TEST(SyspropGeneratedTest, InlineListReadDoesNotAllocate) {
+  ASSERT_EQ(__system_property_set("ints", "1,2,3,4,5,6,7,8,9,10"), 0);
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9,zz,bcd,e_e"), 0);
+  ASSERT_EQ(__system_property_set("strings", "one,two,,three"), 0);
+
+  // Resolve the handles first.
+  ints_Inline();
+  letters_Inline();
+  strings_Inline();
+
+  ScopedAllocationCounter counter;
+  EXPECT_EQ(ints_Inline().size(), 10u);
+  EXPECT_EQ(letters_Inline().size(), 7u);
+  EXPECT_EQ(strings_Inline().size(), 4u);
+  EXPECT_EQ(counter.count(), 0);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+TEST(SyspropGeneratedTest, ParseIntegerList) {
+  ASSERT_EQ(__system_property_set("ints", "1,,-3, 4,x,2147483648,0x10,"), 0);
+  std::vector<std::optional<std::int32_t>> expected = {
+      1, std::nullopt, -3, 4, std::nullopt, std::nullopt, 16, std::nullopt,
+  };
+  EXPECT_EQ(ints(), expected);
+}
+
+TEST(SyspropGeneratedTest, ParseBooleanList) {
+  ASSERT_EQ(__system_property_set("bools", "1,true,TrUe,0,false,FALSE,,yes"),
+            0);
+  std::vector<std::optional<bool>> expected = {
+      true, true, true, false, false, false, std::nullopt, std::nullopt,
+  };
+  EXPECT_EQ(bools(), expected);
+}
+
+TEST(SyspropGeneratedTest, ParseDoubleList) {
+  ASSERT_EQ(__system_property_set("doubles", "1.5,-2e3,,inf,1e999,1.5x"), 0);
+  std::vector<std::optional<double>> expected = {
+      1.5, -2e3, std::nullopt, HUGE_VAL, std::nullopt, std::nullopt,
+  };
+  EXPECT_EQ(doubles(), expected);
+}
+
+TEST(SyspropGeneratedTest, ParseLongListElement) {
+  // Elements of "ro." values may be longer than PROP_VALUE_MAX.
+  std::string value = "1," + std::string(200, ' ') + "2,3";
+  ASSERT_EQ(__system_property_set("ro.long_ints", value.c_str()), 0);
+  std::vector<std::optional<std::int32_t>> expected = {1, 2, 3};
+  EXPECT_EQ(long_ints(), expected);
+}
+
+TEST(SyspropGeneratedTest, ListReadAllocatesOnlyResult) {
+  std::string value;
+  for (int i = 0; i < 30; ++i) value += std::to_string(i) + ",";
+  ASSERT_EQ(__system_property_set("ints", value.c_str()), 0);
+  ASSERT_EQ(__system_property_set("bools", "true,0,,1,false,true,1,0"), 0);
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9,zz,bcd,e_e"), 0);
+
+  // Resolve the handles first.
+  ints();
+  bools();
+  letters();
+
+  {
+    ScopedAllocationCounter counter;
+    EXPECT_EQ(ints().size(), 31u);
+    EXPECT_EQ(counter.count(), 1);
+  }
+  {
+    ScopedAllocationCounter counter;
+    EXPECT_EQ(bools().size(), 8u);
+    EXPECT_EQ(counter.count(), 1);
+  }
+  {
+    ScopedAllocationCounter counter;
+    EXPECT_EQ(letters().size(), 7u);
+    EXPECT_EQ(counter.count(), 1);
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+TEST(SyspropGeneratedTest, PmrGettersAllocateOnlyFromResource) {
+  // Longer than any small string buffer.
+  std::string long_value(40, 'x');
+  ASSERT_EQ(__system_property_set("serial_string", long_value.c_str()), 0);
+  ASSERT_EQ(__system_property_set("strings", ("a,," + long_value).c_str()), 0);
+  ASSERT_EQ(__system_property_set("ints", "1,2,3,4,5,6,7,8,9,10"), 0);
+  ASSERT_EQ(__system_property_set("letters", "a,abd,,X9"), 0);
+
+  // Resolve the handles first.
+  std::pmr::monotonic_buffer_resource warm_up;
+  serial_string(warm_up);
+  strings(warm_up);
+  ints(warm_up);
+  letters(warm_up);
+
+  alignas(std::max_align_t) std::byte buffer[4096];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  ScopedAllocationCounter counter;
+  auto string_value = serial_string(resource);
+  auto strings_value = strings(resource);
+  auto ints_value = ints(resource);
+  auto letters_value = letters(resource);
+  EXPECT_EQ(counter.count(), 0);
+
+  ASSERT_TRUE(string_value.has_value());
+  EXPECT_EQ(*string_value, long_value.c_str());
+  EXPECT_EQ(string_value->get_allocator().resource(), &resource);
+
+  ASSERT_EQ(strings_value.size(), 3u);
+  EXPECT_EQ(strings_value[0], "a");
+  EXPECT_EQ(strings_value[1], std::nullopt);
+  EXPECT_EQ(strings_value[2], long_value.c_str());
+  EXPECT_EQ(strings_value[2]->get_allocator().resource(), &resource);
+  EXPECT_EQ(strings_value.get_allocator().resource(), &resource);
+
+  EXPECT_EQ(ints_value.size(), 10u);
+  EXPECT_EQ(ints_value.get_allocator().resource(), &resource);
+  EXPECT_EQ(letters_value.size(), 4u);
+  EXPECT_EQ(letters_value[1], letters_values::ABD);
+}
+
+TEST(SyspropGeneratedTest, PmrGettersMatchDefaultGetters) {
+  ASSERT_EQ(__system_property_set("bools", "1,true,0,,yes"), 0);
+  ASSERT_EQ(__system_property_set("doubles", "1.5,-2e3,,inf"), 0);
+
+  std::pmr::monotonic_buffer_resource resource;
+  auto bools_value = bools(resource);
+  auto doubles_value = doubles(resource);
+  EXPECT_EQ(std::vector(bools_value.begin(), bools_value.end()), bools());
+  EXPECT_EQ(std::vector(doubles_value.begin(), doubles_value.end()),
+            doubles());
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+TEST(SyspropGeneratedTest, SetFormatsValues) {
+  EXPECT_TRUE(ints({1, std::nullopt, -2147483647 - 1, 2147483647}));
+  EXPECT_EQ(GetFakeProperty("ints"), "1,,-2147483648,2147483647");
+
+  EXPECT_TRUE(bools({true, std::nullopt, false}));
+  EXPECT_EQ(GetFakeProperty("bools"), "true,,false");
+
+  EXPECT_TRUE(letters({letters_values::AB, std::nullopt, letters_values::X9}));
+  EXPECT_EQ(GetFakeProperty("letters"), "ab,,X9");
+
+  EXPECT_TRUE(ints({}));
+  EXPECT_EQ(GetFakeProperty("ints"), "");
+}
+
+TEST(SyspropGeneratedTest, SetFormatsDoublesLikePrintf) {
+  const std::vector<double> values = {
+      0.0, -0.0, 0.1, 1.0 / 3, 1e100, -2.5e-300,
+      std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::denorm_min(),
+  };
+  for (double value : values) {
+    char expected[64];
+    std::snprintf(expected, sizeof(expected), "%.17g", value);
+    EXPECT_TRUE(doubles({value}));
+    EXPECT_EQ(GetFakeProperty("doubles"), expected);
+  }
+}
+
+TEST(SyspropGeneratedTest, SetRejectsOversizedValue) {
+  ASSERT_TRUE(ints({1, 2, 3}));
+
+  // 23 elements of "-1000000," are longer than PROP_VALUE_MAX.
+  // The setter rejects it without calling the property service.
+  std::vector<std::optional<std::int32_t>> too_long(23, -1000000);
+  std::uint64_t calls = GetFakeSetCallCount();
+  errno = 0;
+  EXPECT_FALSE(ints(too_long));
+  EXPECT_EQ(errno, E2BIG);
+  EXPECT_EQ(GetFakeSetCallCount(), calls);
+  EXPECT_EQ(GetFakeProperty("ints"), "1,2,3");
+
+  // The longest value that fits still goes through.
+  std::vector<std::optional<std::int32_t>> fits(10, -1000000);
+  fits.push_back(1);
+  EXPECT_TRUE(ints(fits));
+  EXPECT_EQ(GetFakeProperty("ints")->size(), PROP_VALUE_MAX - 1u);
+}
+
+TEST(SyspropGeneratedTest, SetAllowsLongReadOnlyValue) {
+  std::string value(200, 'x');
+  EXPECT_TRUE(long_string(value));
+  EXPECT_EQ(long_string(), value);
+}
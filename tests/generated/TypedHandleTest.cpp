@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+
+static_assert(std::is_same_v<decltype(ints_prop)::value_type, IntList>);
+static_assert(std::string_view(ints_prop.name) == "ints");
+static_assert(ints_prop.writable);
+static_assert(std::is_empty_v<std::remove_const_t<decltype(ints_prop)>>);
+
+// Generic code over handles, as a metrics or snapshot library would have.
+template <typename P>
+bool SetAndReadBack(P prop, const typename P::value_type& value) {
+  return Set(prop, value) && Get(prop) == value;
+}
+
+template <typename... Props>
+std::vector<std::string> Names(const std::tuple<Props...>&) {
+  return {Props::name...};
+}
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, TypedHandleCallsAccessors) {
+  ASSERT_TRUE(Set(ints_prop, {1, std::nullopt, 3}));
+  EXPECT_EQ(GetFakeProperty("ints"), "1,,3");
+  EXPECT_EQ(Get(ints_prop), ints());
+
+  EXPECT_TRUE(SetAndReadBack(serial_string_prop, "typed"));
+  EXPECT_TRUE(SetAndReadBack(letter_prop, letter_values::E_E));
+  EXPECT_TRUE(SetAndReadBack(bools_prop, {true, std::nullopt}));
+}
+
+TEST(SyspropGeneratedTest, AllPropsHasEveryHandle) {
+  std::vector<std::string> names = Names(all_props);
+  ASSERT_EQ(names.size(), 13u);
+  EXPECT_EQ(names.front(), "letter");
+  EXPECT_EQ(names.back(), "strings");
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+using namespace std::chrono_literals;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, WaitForReturnsIfPredicateHolds) {
+  ASSERT_TRUE(ints({7}));
+  EXPECT_TRUE(ints_WaitFor([](const IntList& v) { return v == IntList{7}; },
+                           0ns));
+}
+
+TEST(SyspropGeneratedTest, WaitForTimesOut) {
+  ASSERT_TRUE(ints({1}));
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(ints_WaitFor([](const IntList& v) { return v.empty(); }, 50ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+}
+
+TEST(SyspropGeneratedTest, WaitForWakesOnlyOnChangesOfTheProperty) {
+  ASSERT_TRUE(ints({1}));
+
+  std::promise<void> first_call;
+  int calls = 0;
+  std::thread writer([waiting = first_call.get_future()]() {
+    waiting.wait();
+    // None of these may wake the waiter up.
+    for (int i = 0; i < 10; ++i) ASSERT_TRUE(bools({i % 2 == 0}));
+    std::this_thread::sleep_for(20ms);
+    ASSERT_TRUE(ints({2}));
+  });
+
+  EXPECT_TRUE(ints_WaitFor(
+      [&](const IntList& v) {
+        if (++calls == 1) first_call.set_value();
+        return v == IntList{2};
+      },
+      10s));
+  writer.join();
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(SyspropGeneratedTest, WaitForPropertyToBeAdded) {
+  ASSERT_EQ(ready(), std::nullopt);
+
+  std::thread writer([] {
+    std::this_thread::sleep_for(20ms);
+    ASSERT_TRUE(ready(true));
+  });
+
+  EXPECT_TRUE(ready_WaitFor(
+      [](const std::optional<bool>& v) { return v == true; }, 10s));
+  writer.join();
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sys/system_properties.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, CachedValueIsReusedWhileSerialIsUnchanged) {
+  ASSERT_TRUE(ints({1, 2}));
+  EXPECT_EQ(ints(), (IntList{1, 2}));
+
+  std::uint64_t reads = GetFakeReadCount();
+  EXPECT_EQ(ints(), (IntList{1, 2}));
+  EXPECT_EQ(ints(), (IntList{1, 2}));
+  EXPECT_EQ(GetFakeReadCount(), reads);
+}
+
+TEST(SyspropGeneratedTest, CachedValueIsParsedAgainAfterSet) {
+  ASSERT_TRUE(ints({1, 2}));
+  EXPECT_EQ(ints(), (IntList{1, 2}));
+
+  // Set past the generated setter, like another process would.
+  std::uint64_t reads = GetFakeReadCount();
+  ASSERT_EQ(__system_property_set("ints", "3,,4"), 0);
+  EXPECT_EQ(ints(), (IntList{3, std::nullopt, 4}));
+  EXPECT_EQ(GetFakeReadCount(), reads + 1);
+
+  EXPECT_EQ(ints(), (IntList{3, std::nullopt, 4}));
+  EXPECT_EQ(GetFakeReadCount(), reads + 1);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+
+#include <gtest/gtest.h>
+#include <sys/system_properties.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+// No other test touches late_string, so it doesn't exist until set here.
+TEST(SyspropGeneratedTest, PrewarmResolvesPropertiesCreatedLater) {
+  Prewarm();
+  EXPECT_EQ(late_string(), std::nullopt);
+
+  // Created past the generated setter, like another process would.
+  ASSERT_EQ(__system_property_set("late_string", "late"), 0);
+  Prewarm();
+
+  std::uint64_t finds = GetFakeFindCount();
+  EXPECT_EQ(late_string(), "late");
+  EXPECT_EQ(GetFakeFindCount(), finds);
+}
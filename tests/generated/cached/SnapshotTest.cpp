@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sys/system_properties.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+using StringList = std::vector<std::optional<std::string>>;
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, ReadSnapshotFillsEveryField) {
+  ASSERT_TRUE(letter(letter_values::BCD));
+  ASSERT_TRUE(letters({letters_values::A, letters_values::X9}));
+  ASSERT_TRUE(ints({5, std::nullopt}));
+  ASSERT_TRUE(bools({false, true}));
+  ASSERT_TRUE(doubles({0.5}));
+  ASSERT_TRUE(serial_string("snapshot"));
+  ASSERT_TRUE(serial_strings({"s", "t"}));
+  ASSERT_TRUE(strings({"x"}));
+
+  // "ro." properties and ready are left to other tests, which expect to set
+  // them first. Fields start out with values no getter returns here, so that
+  // those which ReadSnapshot() skipped stand out.
+  TestPropertiesSnapshot snapshot;
+  snapshot.long_ints = {-1};
+  snapshot.long_string = "stale";
+  snapshot.ready = false;
+  snapshot.boot_ints = {-1};
+  snapshot.late_string = "stale";
+  ReadSnapshot(&snapshot);
+  EXPECT_EQ(snapshot.letter, letter_values::BCD);
+  EXPECT_EQ(snapshot.letters,
+            (std::vector<std::optional<letters_values>>{letters_values::A,
+                                                        letters_values::X9}));
+  EXPECT_EQ(snapshot.ints, (IntList{5, std::nullopt}));
+  EXPECT_EQ(snapshot.bools, (std::vector<std::optional<bool>>{false, true}));
+  EXPECT_EQ(snapshot.doubles, (std::vector<std::optional<double>>{0.5}));
+  EXPECT_EQ(snapshot.serial_string, "snapshot");
+  EXPECT_EQ(snapshot.serial_strings, (StringList{"s", "t"}));
+  EXPECT_EQ(snapshot.strings, (StringList{"x"}));
+  EXPECT_EQ(snapshot.long_ints, long_ints());
+  EXPECT_EQ(snapshot.long_string, long_string());
+  EXPECT_EQ(snapshot.ready, ready());
+  EXPECT_EQ(snapshot.boot_ints, boot_ints());
+  EXPECT_EQ(snapshot.late_string, late_string());
+  EXPECT_EQ(snapshot.area_serial, __system_property_area_serial());
+}
+
+TEST(SyspropGeneratedTest, SnapshotIsStaleAfterAnySet) {
+  // Moves the area serial past 0 if this test runs first.
+  ASSERT_EQ(__system_property_set("snapshot_test.unrelated", "0"), 0);
+
+  TestPropertiesSnapshot snapshot;
+  ReadSnapshot(&snapshot);
+  EXPECT_FALSE(IsStale(snapshot));
+
+  ASSERT_EQ(__system_property_set("snapshot_test.unrelated", "1"), 0);
+  EXPECT_TRUE(IsStale(snapshot));
+
+  ReadSnapshot(&snapshot);
+  EXPECT_FALSE(IsStale(snapshot));
+}
+
+TEST(SyspropGeneratedTest, SnapshotAtAreaSerialZeroIsStale) {
+  TestPropertiesSnapshot never_read;
+  EXPECT_TRUE(IsStale(never_read));
+
+  // 0 marks snapshots which were never read, so one read while the area
+  // serial has wrapped around to 0 can't be told apart from those.
+  ScopedFakeAreaSerial wrapped(0);
+  TestPropertiesSnapshot snapshot;
+  ReadSnapshot(&snapshot);
+  EXPECT_EQ(snapshot.area_serial, 0u);
+  EXPECT_EQ(snapshot.ints, ints());
+  EXPECT_TRUE(IsStale(snapshot));
+}
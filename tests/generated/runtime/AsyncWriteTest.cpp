@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/system_properties.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FakeSystemProperties.h"
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+
+TEST(SyspropGeneratedTest, SetAsyncWritesValue) {
+  WriteToken token = ints_SetAsync({1, std::nullopt, 2});
+  EXPECT_TRUE(token.Wait());
+  EXPECT_TRUE(token.done());
+  EXPECT_EQ(GetFakeProperty("ints"), "1,,2");
+
+  EXPECT_TRUE(letter_SetAsync(letter_values::ABD).Wait());
+  EXPECT_EQ(GetFakeProperty("letter"), "abd");
+}
+
+TEST(SyspropGeneratedTest, SetAsyncSendsOnlyLastValue) {
+  Flush();
+  std::uint64_t sets = GetFakeSetCount();
+  WriteToken first, last;
+  {
+    ScopedBlockFakeSets block;
+    // The writer thread may already be stuck writing this one.
+    first = ints_SetAsync({1});
+    for (int i = 2; i <= 10; ++i) last = ints_SetAsync({i});
+    EXPECT_FALSE(last.done());
+  }
+  EXPECT_TRUE(last.Wait());
+  EXPECT_TRUE(first.done());
+  EXPECT_EQ(GetFakeProperty("ints"), "10");
+  EXPECT_LE(GetFakeSetCount() - sets, 2u);
+}
+
+TEST(SyspropGeneratedTest, FlushWaitsForQueuedValues) {
+  ints_SetAsync({7});
+  bools_SetAsync({true, false});
+  serial_string_SetAsync("flushed");
+  Flush();
+  EXPECT_EQ(GetFakeProperty("ints"), "7");
+  EXPECT_EQ(GetFakeProperty("bools"), "true,false");
+  EXPECT_EQ(serial_string(), "flushed");
+}
+
+TEST(SyspropGeneratedTest, SetAsyncKeepsLastValueOfEachThread) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < 1000; ++i) ints_SetAsync({t, i});
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  Flush();
+
+  auto value = ints();
+  ASSERT_EQ(value.size(), 2u);
+  EXPECT_EQ(value[1], 999);
+}
+
+TEST(SyspropGeneratedTest, SetAsyncRejectsTooLongValue) {
+  errno = 0;
+  WriteToken token = serial_string_SetAsync(std::string(PROP_VALUE_MAX, 'x'));
+  EXPECT_EQ(errno, E2BIG);
+  EXPECT_TRUE(token.done());
+  EXPECT_FALSE(token.Wait());
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TestProperties.sysprop.h"
+
+using namespace android::sysprop::TestProperties;
+using namespace std::chrono_literals;
+
+namespace {
+
+using IntList = std::vector<std::optional<std::int32_t>>;
+
+}  // namespace
+
+TEST(SyspropGeneratedTest, WatcherPassesParsedValue) {
+  ASSERT_TRUE(ints({1}));
+
+  std::promise<IntList> value;
+  Watcher watcher;
+  watcher.ints_OnChange([&](const IntList& v) { value.set_value(v); });
+  ASSERT_TRUE(ints({3, 4}));
+
+  auto future = value.get_future();
+  ASSERT_EQ(future.wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(future.get(), (IntList{3, 4}));
+}
+
+TEST(SyspropGeneratedTest, WatcherIgnoresOtherProperties) {
+  ASSERT_TRUE(ints({1}));
+
+  std::atomic<int> calls{0};
+  std::promise<void> called;
+  Watcher watcher;
+  watcher.ints_OnChange([&](const IntList&) {
+    if (++calls == 1) called.set_value();
+  });
+  for (int i = 0; i < 10; ++i) ASSERT_TRUE(bools({i % 2 == 0}));
+  std::this_thread::sleep_for(20ms);
+  ASSERT_TRUE(ints({2}));
+
+  ASSERT_EQ(called.get_future().wait_for(10s), std::future_status::ready);
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(SyspropGeneratedTest, WatcherCoalescesChanges) {
+  ASSERT_TRUE(ints({0}));
+
+  // The first callback blocks the watcher thread while the burst is written.
+  std::promise<void> entered;
+  std::promise<void> burst_written;
+  std::promise<IntList> last_value;
+  std::atomic<int> calls{0};
+  Watcher watcher;
+  watcher.ints_OnChange(
+      [&, burst = burst_written.get_future().share()](const IntList& v) {
+        if (++calls == 1) {
+          entered.set_value();
+          burst.wait();
+        } else {
+          last_value.set_value(v);
+        }
+      });
+  ASSERT_TRUE(ints({1}));
+  ASSERT_EQ(entered.get_future().wait_for(10s), std::future_status::ready);
+  for (int i = 2; i <= 5; ++i) ASSERT_TRUE(ints({i}));
+  burst_written.set_value();
+
+  auto future = last_value.get_future();
+  ASSERT_EQ(future.wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(future.get(), IntList{5});
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(SyspropGeneratedTest, WatcherStopsWhenDestroyed) {
+  std::atomic<int> removed_calls{0};
+  {
+    Watcher watcher;
+    watcher.ints_OnChange([&](const IntList&) { ++removed_calls; });
+  }
+
+  std::promise<void> called;
+  Watcher watcher;
+  watcher.ints_OnChange([&](const IntList&) { called.set_value(); });
+  ASSERT_TRUE(ints({6}));
+
+  ASSERT_EQ(called.get_future().wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(removed_calls, 0);
+}
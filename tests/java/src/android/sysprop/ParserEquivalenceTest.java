@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package android.sysprop;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+import android.os.SystemProperties;
+
+import java.util.ArrayList;
+import java.util.BitSet;
+import java.util.List;
+import java.util.Locale;
+import java.util.Optional;
+import java.util.OptionalDouble;
+import java.util.OptionalInt;
+import java.util.OptionalLong;
+import java.util.Random;
+import java.util.function.Function;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+import org.junit.runners.JUnit4;
+
+/**
+ * Checks that the parsers of generated classes accept exactly what the try/catch based ones they
+ * replaced accepted, and return the same values.
+ */
+@RunWith(JUnit4.class)
+public final class ParserEquivalenceTest {
+    private static final String[] EDGE_CASES = {
+        "",
+        "0",
+        "-0",
+        "+0",
+        "+",
+        "-",
+        "+-1",
+        "--1",
+        "-+1",
+        "2147483647",
+        "2147483648",
+        "-2147483648",
+        "-2147483649",
+        "+2147483647",
+        "9223372036854775807",
+        "9223372036854775808",
+        "-9223372036854775808",
+        "-9223372036854775809",
+        "99999999999999999999",
+        "0000000000000000000000000000000000000001",
+        "\u0661\u0662",
+        "-\u0967\u0968",
+        "\uff11",
+        "1\u0660",
+        "1.\u0661",
+        " 1",
+        "1 ",
+        "\t-1\n",
+        " -1.5 ",
+        "\u00a01",
+        "1_000",
+        "0x10",
+        "0X1p3",
+        "0x1.8p1",
+        "-0x1p-1074",
+        "0x1P+3d",
+        "0x.8p1",
+        "0x.p1",
+        "0x1.p1f",
+        "0x1",
+        "0xp1",
+        "0x",
+        "0x1p",
+        "0xg",
+        "1e5",
+        "1E-5",
+        "1e",
+        "1e+",
+        "1ee5",
+        ".5",
+        "5.",
+        ".",
+        "-.5e-3",
+        "1.5f",
+        "1.5F",
+        "1.5d",
+        "1.5D",
+        "1.5df",
+        "1f ",
+        "1e400",
+        "-1e400",
+        "4.9e-324",
+        "2.4703282292062327e-324",
+        "1.7976931348623157e308",
+        "NaN",
+        "-NaN",
+        "+NaN",
+        "nan",
+        "NaNd",
+        " NaN ",
+        "Infinity",
+        "-Infinity",
+        "+Infinity",
+        "Infinityd",
+        "infinity",
+        "Inf",
+        "true",
+        "TRUE",
+        "True",
+        "tRuE",
+        "false",
+        "FALSE",
+        "fAlSe",
+        "1",
+        "yes",
+        "ture",
+        "truee",
+        " true",
+        "\u0130",
+        "tru\u0130",
+        "\u212a",
+        "t\u0280ue",
+    };
+
+    // Spellings of the values of enum_value which only match them after case mapping, some of them
+    // only through Unicode case folding: KELVIN SIGN, sharp s and dotted or dotless i.
+    private static final String[] ENUM_CASES = {
+        "k",
+        "K",
+        "\u212a",
+        "ss",
+        "SS",
+        "sS",
+        "\u00df",
+        "\u1e9e",
+        "i",
+        "I",
+        "\u0130",
+        "\u0131",
+        "on",
+        "ON",
+        "oN",
+        "Auto",
+        "auto",
+        "AUTO",
+        " auto",
+        "autos",
+    };
+
+    // Characters which mean something to at least one of the parsers.
+    private static final String ALPHABET = "019+-.eEfdxXpPaNIny \t\u0661";
+
+    private static final List<String> INPUTS = makeInputs();
+    private static final List<String> LISTS = makeLists();
+
+    // Every string of up to 3 characters of ALPHABET, the edge cases, and random longer strings.
+    private static List<String> makeInputs() {
+        List<String> ret = new ArrayList<>();
+        ret.add("");
+        for (int begin = 0; ret.get(begin).length() < 3; ) {
+            int end = ret.size();
+            for (int i = begin; i < end; ++i) {
+                for (int c = 0; c < ALPHABET.length(); ++c) {
+                    ret.add(ret.get(i) + ALPHABET.charAt(c));
+                }
+            }
+            begin = end;
+        }
+        for (String edgeCase : EDGE_CASES) ret.add(edgeCase);
+        Random random = new Random(42);
+        for (int i = 0; i < 50000; ++i) {
+            StringBuilder builder = new StringBuilder();
+            int length = 4 + random.nextInt(20);
+            for (int j = 0; j < length; ++j) {
+                builder.append(ALPHABET.charAt(random.nextInt(ALPHABET.length())));
+            }
+            ret.add(builder.toString());
+        }
+        return ret;
+    }
+
+    // Up to 4 elements joined with commas, with and without trailing empty elements.
+    private static List<String> makeLists() {
+        List<String> ret = new ArrayList<>();
+        ret.add(",");
+        ret.add(",,");
+        Random random = new Random(42);
+        for (int i = 0; i < 20000; ++i) {
+            StringBuilder builder = new StringBuilder();
+            int elements = 1 + random.nextInt(4);
+            for (int j = 0; j < elements; ++j) {
+                if (j > 0) builder.append(',');
+                String element = random.nextInt(4) == 0
+                        ? EDGE_CASES[random.nextInt(EDGE_CASES.length)]
+                        : INPUTS.get(random.nextInt(INPUTS.size()));
+                builder.append(element);
+            }
+            if (random.nextInt(8) == 0) builder.append(',');
+            ret.add(builder.toString());
+        }
+        return ret;
+    }
+
+    private static Boolean legacyParseBoolean(String str) {
+        switch (str.toLowerCase(Locale.US)) {
+            case "1":
+            case "true":
+                return Boolean.TRUE;
+            case "0":
+            case "false":
+                return Boolean.FALSE;
+            default:
+                return null;
+        }
+    }
+
+    private static Integer legacyParseInteger(String str) {
+        try {
+            return Integer.valueOf(str);
+        } catch (NumberFormatException e) {
+            return null;
+        }
+    }
+
+    private static Long legacyParseLong(String str) {
+        try {
+            return Long.valueOf(str);
+        } catch (NumberFormatException e) {
+            return null;
+        }
+    }
+
+    private static Double legacyParseDouble(String str) {
+        try {
+            return Double.valueOf(str);
+        } catch (NumberFormatException e) {
+            return null;
+        }
+    }
+
+    private static ParserProperties.enum_value_values legacyParseEnum(String str) {
+        try {
+            return Enum.valueOf(ParserProperties.enum_value_values.class, str.toUpperCase(Locale.US));
+        } catch (IllegalArgumentException e) {
+            return null;
+        }
+    }
+
+    private static <T> List<T> legacyParseList(Function<String, T> elementParser, String str) {
+        List<T> ret = new ArrayList<>();
+        if ("".equals(str)) return ret;
+        for (String element : str.split(",")) {
+            ret.add(elementParser.apply(element));
+        }
+        return ret;
+    }
+
+    private static String describe(String input) {
+        StringBuilder builder = new StringBuilder("\"");
+        for (int i = 0; i < input.length(); ++i) {
+            char c = input.charAt(i);
+            if (c >= ' ' && c < 0x7f) {
+                builder.append(c);
+            } else {
+                builder.append(String.format("\\u%04x", (int) c));
+            }
+        }
+        return builder.append('"').toString();
+    }
+
+    // Checks that the array of |length| elements read by |element| holds the non-null elements of
+    // |expected|, and that |present| is set for exactly those.
+    private static <T> void assertArrayMatches(
+            String input, List<T> expected, int length, BitSet present,
+            Function<Integer, T> element) {
+        String message = describe(input);
+        assertEquals(message, expected.size(), length);
+        for (int i = 0; i < expected.size(); ++i) {
+            if (expected.get(i) == null) {
+                assertFalse(message, present.get(i));
+            } else {
+                assertTrue(message, present.get(i));
+                assertEquals(message, expected.get(i), element.apply(i));
+            }
+        }
+        assertEquals(message, -1, present.nextSetBit(expected.size()));
+    }
+
+    @Test
+    public void booleanParserMatchesLegacy() {
+        for (String input : INPUTS) {
+            SystemProperties.set("bool_value", input);
+            Boolean expected = legacyParseBoolean(input);
+            assertEquals(describe(input), Optional.ofNullable(expected),
+                    ParserProperties.bool_value());
+            assertEquals(describe(input), expected != null ? expected : false,
+                    ParserProperties.bool_value_orElse(false));
+            assertEquals(describe(input), expected != null ? expected : true,
+                    ParserProperties.bool_value_orElse(true));
+        }
+    }
+
+    @Test
+    public void integerParserMatchesLegacy() {
+        for (String input : INPUTS) {
+            SystemProperties.set("int_value", input);
+            Integer expected = legacyParseInteger(input);
+            assertEquals(describe(input), Optional.ofNullable(expected),
+                    ParserProperties.int_value());
+            assertEquals(describe(input),
+                    expected != null ? OptionalInt.of(expected) : OptionalInt.empty(),
+                    ParserProperties.int_value_asOptionalInt());
+            assertEquals(describe(input), expected != null ? (int) expected : -7,
+                    ParserProperties.int_value_orElse(-7));
+        }
+    }
+
+    @Test
+    public void longParserMatchesLegacy() {
+        for (String input : INPUTS) {
+            SystemProperties.set("long_value", input);
+            Long expected = legacyParseLong(input);
+            assertEquals(describe(input), Optional.ofNullable(expected),
+                    ParserProperties.long_value());
+            assertEquals(describe(input),
+                    expected != null ? OptionalLong.of(expected) : OptionalLong.empty(),
+                    ParserProperties.long_value_asOptionalLong());
+            assertEquals(describe(input), expected != null ? (long) expected : -7L,
+                    ParserProperties.long_value_orElse(-7L));
+        }
+    }
+
+    // Optional<Double> and OptionalDouble compare NaNs and the sign of zero bit by bit.
+    @Test
+    public void doubleParserMatchesLegacy() {
+        for (String input : INPUTS) {
+            SystemProperties.set("double_value", input);
+            Double expected = legacyParseDouble(input);
+            assertEquals(describe(input), Optional.ofNullable(expected),
+                    ParserProperties.double_value());
+            assertEquals(describe(input),
+                    expected != null ? OptionalDouble.of(expected) : OptionalDouble.empty(),
+                    ParserProperties.double_value_asOptionalDouble());
+            assertEquals(describe(input),
+                    Double.valueOf(expected != null ? expected : -7.0),
+                    Double.valueOf(ParserProperties.double_value_orElse(-7.0)));
+        }
+    }
+
+    @Test
+    public void enumParserMatchesLegacy() {
+        List<String> inputs = new ArrayList<>(INPUTS);
+        for (String enumCase : ENUM_CASES) inputs.add(enumCase);
+        for (String input : inputs) {
+            SystemProperties.set("enum_value", input);
+            assertEquals(describe(input), Optional.ofNullable(legacyParseEnum(input)),
+                    ParserProperties.enum_value());
+        }
+    }
+
+    @Test
+    public void listParsersMatchLegacy() {
+        BitSet present = new BitSet();
+        for (String input : LISTS) {
+            SystemProperties.set("bool_list", input);
+            List<Boolean> bools = legacyParseList(v -> legacyParseBoolean(v), input);
+            assertEquals(describe(input), bools, ParserProperties.bool_list());
+            boolean[] boolArray = ParserProperties.bool_list_asArray(present);
+            assertArrayMatches(input, bools, boolArray.length, present, i -> boolArray[i]);
+
+            SystemProperties.set("int_list", input);
+            List<Integer> ints = legacyParseList(v -> legacyParseInteger(v), input);
+            assertEquals(describe(input), ints, ParserProperties.int_list());
+            int[] intArray = ParserProperties.int_list_asArray(present);
+            assertArrayMatches(input, ints, intArray.length, present, i -> intArray[i]);
+
+            SystemProperties.set("long_list", input);
+            List<Long> longs = legacyParseList(v -> legacyParseLong(v), input);
+            assertEquals(describe(input), longs, ParserProperties.long_list());
+            long[] longArray = ParserProperties.long_list_asArray(present);
+            assertArrayMatches(input, longs, longArray.length, present, i -> longArray[i]);
+
+            SystemProperties.set("double_list", input);
+            List<Double> doubles = legacyParseList(v -> legacyParseDouble(v), input);
+            assertEquals(describe(input), doubles, ParserProperties.double_list());
+            double[] doubleArray = ParserProperties.double_list_asArray(present);
+            assertArrayMatches(input, doubles, doubleArray.length, present,
+                    i -> doubleArray[i]);
+        }
+    }
+}
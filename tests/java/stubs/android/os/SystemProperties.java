@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package android.os;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Host stand-in for the parts of android.os.SystemProperties which generated classes use, so
+ * that host tests can run them. Properties live in a map of this process.
+ */
+public final class SystemProperties {
+    private static final Map<String, String> sProperties = new HashMap<>();
+
+    private SystemProperties() {}
+
+    /** Returns the value of |key|, or "" if it has never been set. */
+    public static synchronized String get(String key) {
+        return sProperties.getOrDefault(key, "");
+    }
+
+    public static synchronized void set(String key, String val) {
+        sProperties.put(key, val);
+    }
+}
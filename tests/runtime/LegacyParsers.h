@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_TOOLS_SYSPROP_TESTS_LEGACY_PARSERS_H_
+#define SYSTEM_TOOLS_SYSPROP_TESTS_LEGACY_PARSERS_H_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <strings.h>
+#include <sys/system_properties.h>
+
+#include <android-base/parseint.h>
+
+// The strncasecmp(), ParseInt() and strtod() based parsers which the runtime
+// used before switching to from_chars(). The new ones must accept exactly the
+// same inputs.
+namespace legacy {
+
+template <typename Parse>
+auto WithCString(std::string_view str, Parse parse) {
+  char buf[PROP_VALUE_MAX];
+  if (str.size() < sizeof(buf)) {
+    std::memcpy(buf, str.data(), str.size());
+    buf[str.size()] = '\0';
+    return parse(buf);
+  }
+  return parse(std::string(str).c_str());
+}
+
+inline std::optional<bool> ParseBool(std::string_view str) {
+  static constexpr std::string_view kYes[] = {"1", "true"};
+  static constexpr std::string_view kNo[] = {"0", "false"};
+
+  for (std::string_view yes : kYes) {
+    if (str.size() == yes.size() &&
+        strncasecmp(yes.data(), str.data(), str.size()) == 0) {
+      return std::make_optional(true);
+    }
+  }
+
+  for (std::string_view no : kNo) {
+    if (str.size() == no.size() &&
+        strncasecmp(no.data(), str.data(), str.size()) == 0) {
+      return std::make_optional(false);
+    }
+  }
+
+  return std::nullopt;
+}
+
+template <typename T>
+std::optional<T> ParseInt(std::string_view str) {
+  return WithCString(str, [](const char* s) -> std::optional<T> {
+    T ret;
+    return android::base::ParseInt(s, &ret) ? std::make_optional(ret)
+                                            : std::nullopt;
+  });
+}
+
+inline std::optional<double> ParseDouble(std::string_view str) {
+  return WithCString(str, [](const char* s) -> std::optional<double> {
+    int old_errno = errno;
+    errno = 0;
+    char* end;
+    double ret = std::strtod(s, &end);
+    if (errno != 0) {
+      return std::nullopt;
+    }
+    if (s == end || *end != '\0') {
+      errno = EINVAL;
+      return std::nullopt;
+    }
+    errno = old_errno;
+    return std::make_optional(ret);
+  });
+}
+
+}  // namespace legacy
+
+#endif  // SYSTEM_TOOLS_SYSPROP_TESTS_LEGACY_PARSERS_H_
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+#include <sysprop/Runtime.h>
+
+#include "LegacyParsers.h"
+
+using android::sysprop::runtime::DoParse;
+
+namespace {
+
+// Typical property values.
+constexpr std::string_view kBools[] = {"true", "0", "False", "1", "yes"};
+constexpr std::string_view kInts[] = {"0", "1", "-1", "4096", "2147483647",
+                                      "0x7f", "-500", "65536"};
+constexpr std::string_view kDoubles[] = {"0", "1.5", "-0.25", "3.14159",
+                                         "1e-3", "60.0", "0.1", "1234.5678"};
+
+template <typename Parse, std::size_t N>
+void Run(benchmark::State& state, const std::string_view (&inputs)[N],
+         Parse parse) {
+  for (auto _ : state) {
+    for (std::string_view input : inputs) {
+      benchmark::DoNotOptimize(parse(input));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_ParseBool_Legacy(benchmark::State& state) {
+  Run(state, kBools, legacy::ParseBool);
+}
+BENCHMARK(BM_ParseBool_Legacy);
+
+void BM_ParseBool(benchmark::State& state) {
+  Run(state, kBools, DoParse<std::optional<bool>>);
+}
+BENCHMARK(BM_ParseBool);
+
+void BM_ParseInt32_Legacy(benchmark::State& state) {
+  Run(state, kInts, legacy::ParseInt<std::int32_t>);
+}
+BENCHMARK(BM_ParseInt32_Legacy);
+
+void BM_ParseInt32(benchmark::State& state) {
+  Run(state, kInts, DoParse<std::optional<std::int32_t>>);
+}
+BENCHMARK(BM_ParseInt32);
+
+void BM_ParseInt64_Legacy(benchmark::State& state) {
+  Run(state, kInts, legacy::ParseInt<std::int64_t>);
+}
+BENCHMARK(BM_ParseInt64_Legacy);
+
+void BM_ParseInt64(benchmark::State& state) {
+  Run(state, kInts, DoParse<std::optional<std::int64_t>>);
+}
+BENCHMARK(BM_ParseInt64);
+
+void BM_ParseDouble_Legacy(benchmark::State& state) {
+  Run(state, kDoubles, legacy::ParseDouble);
+}
+BENCHMARK(BM_ParseDouble_Legacy);
+
+void BM_ParseDouble(benchmark::State& state) {
+  Run(state, kDoubles, DoParse<std::optional<double>>);
+}
+BENCHMARK(BM_ParseDouble);
+
+}  // namespace
+
+BENCHMARK_MAIN();
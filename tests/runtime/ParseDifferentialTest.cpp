@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sysprop/Runtime.h>
+
+#include "LegacyParsers.h"
+
+using android::sysprop::runtime::DoParse;
+
+namespace {
+
+// Characters which mean something to at least one of the parsers.
+constexpr char kAlphabet[] = "019aAeEfFxXpP+-. \tiInN()_";
+
+// Every string of up to |max_size| characters of kAlphabet.
+std::vector<std::string> AllStrings(std::size_t max_size) {
+  std::vector<std::string> ret = {""};
+  for (std::size_t begin = 0; ret[begin].size() < max_size;) {
+    std::size_t end = ret.size();
+    for (std::size_t i = begin; i < end; ++i) {
+      for (const char* c = kAlphabet; *c != '\0'; ++c) ret.push_back(ret[i] + *c);
+    }
+    begin = end;
+  }
+  return ret;
+}
+
+constexpr const char* kEdgeCases[] = {
+    "2147483647",
+    "2147483648",
+    "-2147483648",
+    "-2147483649",
+    "0x7fffffff",
+    "0x80000000",
+    "9223372036854775807",
+    "9223372036854775808",
+    "-9223372036854775808",
+    "-9223372036854775809",
+    "0x7FFFFFFFFFFFFFFF",
+    "0x8000000000000000",
+    "0xFFFFFFFFFFFFFFFFF",
+    "00000000000000000000000000000000000000000000000001",
+    "  +12",
+    "\v-3",
+    "\n\r\f 7",
+    "7 ",
+    "+-1",
+    "-+1",
+    "--1",
+    "0x-1",
+    "0x+1",
+    "-0x1",
+    "+0x1",
+    " 0x1",
+    "0X1F",
+    "0x",
+    "0xg",
+    "1e308",
+    "1.7976931348623157e308",
+    "1.7976931348623158e308",
+    "1.7976931348623159e308",
+    "4.9e-324",
+    "2.4703282292062328e-324",
+    "2.4703282292062327e-324",
+    "2.2250738585072014e-308",
+    "2.2250738585072011e-308",
+    "1e-400",
+    "-1e-400",
+    "0e-400",
+    "0.000e999999",
+    "0x1p-1074",
+    "0x1p-1075",
+    "0x1.8p-1074",
+    "0x0.0000000000001p-1022",
+    "0x1.0000000000001p-1022",
+    "0x1p1023",
+    "0x1p1024",
+    "0x.8",
+    "0x.p1",
+    "0x1p",
+    "0x1P+3",
+    "0xinf",
+    "0xnan",
+    "1e",
+    "1e+",
+    "1E-5",
+    ".5",
+    "5.",
+    ".",
+    "inf",
+    "-Infinity",
+    "INFINITY",
+    "infinit",
+    "nan",
+    "-NaN",
+    "nan()",
+    "nan(abc)",
+    "nan(a_b9)",
+    "nan(a-b)",
+    "nan(",
+    "1,5",
+    "true",
+    "TrUe",
+    "false",
+    "FALSE",
+    "yes",
+    "\x94rue",
+    "t\x92ue",
+};
+
+std::vector<std::string> RandomNumbers(int count) {
+  static constexpr const char* kPrefixes[] = {"", "", "", " ", "+", "-", "\t-"};
+  std::mt19937_64 rng(42);
+  std::vector<std::string> ret;
+  char buf[64];
+  for (int i = 0; i < count; ++i) {
+    std::uint64_t bits = rng();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    std::string prefix = kPrefixes[rng() % std::size(kPrefixes)];
+    switch (rng() % 6) {
+      case 0:
+        std::snprintf(buf, sizeof(buf), "%.17g", d);
+        break;
+      case 1:
+        std::snprintf(buf, sizeof(buf), "%a", d);
+        break;
+      case 2:
+        std::snprintf(buf, sizeof(buf), "%.*g", static_cast<int>(rng() % 8),
+                      d);
+        break;
+      case 3:
+        std::snprintf(buf, sizeof(buf), "%" PRId64,
+                      static_cast<std::int64_t>(bits) >> (rng() % 64));
+        break;
+      case 4:
+        std::snprintf(buf, sizeof(buf), "0x%" PRIx64, bits >> (rng() % 64));
+        break;
+      default:
+        // Near the subnormal range, where strtod() and from_chars() differ.
+        std::snprintf(buf, sizeof(buf), "%.*ge-%d",
+                      static_cast<int>(rng() % 20), d - static_cast<int>(d),
+                      300 + static_cast<int>(rng() % 30));
+        break;
+    }
+    ret.push_back(prefix + buf);
+  }
+  return ret;
+}
+
+std::vector<std::string> AllInputs() {
+  std::vector<std::string> ret = AllStrings(4);
+  ret.insert(ret.end(), std::begin(kEdgeCases), std::end(kEdgeCases));
+  std::vector<std::string> random = RandomNumbers(200000);
+  ret.insert(ret.end(), random.begin(), random.end());
+  return ret;
+}
+
+const std::vector<std::string>& Inputs() {
+  static const auto* inputs = new std::vector<std::string>(AllInputs());
+  return *inputs;
+}
+
+// Compares doubles bit by bit, so that NaNs and the sign of zero count.
+bool SameBits(const std::optional<double>& a, const std::optional<double>& b) {
+  if (a.has_value() != b.has_value()) return false;
+  return !a || std::memcmp(&*a, &*b, sizeof(double)) == 0;
+}
+
+}  // namespace
+
+TEST(SyspropRuntimeTest, BoolParserMatchesLegacy) {
+  for (const std::string& input : Inputs()) {
+    EXPECT_EQ(DoParse<std::optional<bool>>(input), legacy::ParseBool(input))
+        << '"' << input << '"';
+  }
+}
+
+TEST(SyspropRuntimeTest, Int32ParserMatchesLegacy) {
+  for (const std::string& input : Inputs()) {
+    EXPECT_EQ(DoParse<std::optional<std::int32_t>>(input),
+              legacy::ParseInt<std::int32_t>(input))
+        << '"' << input << '"';
+  }
+}
+
+TEST(SyspropRuntimeTest, Int64ParserMatchesLegacy) {
+  for (const std::string& input : Inputs()) {
+    EXPECT_EQ(DoParse<std::optional<std::int64_t>>(input),
+              legacy::ParseInt<std::int64_t>(input))
+        << '"' << input << '"';
+  }
+}
+
+TEST(SyspropRuntimeTest, DoubleParserMatchesLegacy) {
+  for (const std::string& input : Inputs()) {
+    EXPECT_TRUE(SameBits(DoParse<std::optional<double>>(input),
+                         legacy::ParseDouble(input)))
+        << '"' << input << '"';
+  }
+}
+
+TEST(SyspropRuntimeTest, ParsersPreserveErrno) {
+  errno = 1234;
+  DoParse<std::optional<std::int32_t>>("x");
+  DoParse<std::optional<double>>("1e-400");
+  DoParse<std::optional<double>>("1e400");
+  EXPECT_EQ(errno, 1234);
+}
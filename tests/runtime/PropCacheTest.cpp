@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sysprop/Runtime.h>
+
+#include "FakeSystemProperties.h"
+
+using android::sysprop::runtime::PropCache;
+using android::sysprop::runtime::PropHandle;
+
+namespace {
+
+TEST(PropCacheTest, ReadIsLockFree) {
+  EXPECT_TRUE(PropCache<std::optional<std::int32_t>>::is_lock_free());
+  EXPECT_TRUE(PropCache<std::optional<std::string>>::is_lock_free());
+  EXPECT_TRUE(
+      PropCache<std::vector<std::optional<std::string>>>::is_lock_free());
+}
+
+TEST(PropCacheTest, ReadsOncePerChange) {
+  ASSERT_EQ(__system_property_set("test.prop_cache.once", "1"), 0);
+  static PropHandle handle("test.prop_cache.once");
+  PropCache<std::optional<std::int32_t>> cache;
+
+  std::uint64_t reads = GetFakeReadCount();
+  EXPECT_EQ(cache.Get(handle), 1);
+  EXPECT_EQ(cache.Get(handle), 1);
+  EXPECT_EQ(GetFakeReadCount(), reads + 1);
+
+  ASSERT_EQ(__system_property_set("test.prop_cache.once", "2"), 0);
+  EXPECT_EQ(cache.Get(handle), 2);
+  EXPECT_EQ(cache.Get(handle), 2);
+  EXPECT_EQ(GetFakeReadCount(), reads + 2);
+}
+
+TEST(PropCacheTest, PutSkipsTheNextRead) {
+  ASSERT_EQ(__system_property_set("test.prop_cache.put", "1"), 0);
+  static PropHandle handle("test.prop_cache.put");
+  PropCache<std::optional<std::int32_t>> cache;
+  EXPECT_EQ(cache.Get(handle), 1);
+
+  ASSERT_EQ(__system_property_set("test.prop_cache.put", "3"), 0);
+  cache.Put("3", __system_property_serial(handle.Find()));
+  std::uint64_t reads = GetFakeReadCount();
+  EXPECT_EQ(cache.Get(handle), 3);
+  EXPECT_EQ(GetFakeReadCount(), reads);
+}
+
+// Readers racing with a writer only ever see values which were written.
+TEST(PropCacheTest, ConcurrentReadsSeeWrittenValues) {
+  ASSERT_EQ(__system_property_set("test.prop_cache.race", "abc0"), 0);
+  static PropHandle handle("test.prop_cache.race");
+  PropCache<std::optional<std::string>> cache;
+
+  std::atomic<bool> done{false};
+  std::atomic<int> bad_reads{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        auto value = cache.Get(handle);
+        if (!value || value->compare(0, 3, "abc") != 0) ++bad_reads;
+      }
+    });
+  }
+  for (int i = 1; i <= 200; ++i) {
+    std::string value = "abc" + std::to_string(i);
+    EXPECT_EQ(__system_property_set("test.prop_cache.race", value.c_str()), 0);
+  }
+  done = true;
+  for (auto& reader : readers) reader.join();
+
+  EXPECT_EQ(bad_reads, 0);
+  EXPECT_EQ(cache.Get(handle), "abc200");
+}
+
+}  // namespace
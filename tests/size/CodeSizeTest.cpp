@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the code of tests/size/LargeProperties.sysprop compiled without
+// --runtime, with --runtime and with --runtime --table. The object files are
+// built next to this test, each from the source of one mode alone.
+
+#include <elf.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <android-base/file.h>
+#include <android-base/strings.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Returns the size of the code in the 64-bit ELF object at |path|: the sum of
+// .text and of the .text.* sections -ffunction-sections splits it into.
+std::uint64_t TextSize(const std::string& path) {
+  std::string elf;
+  if (!android::base::ReadFileToString(path, &elf)) {
+    ADD_FAILURE() << "Can't read " << path;
+    return 0;
+  }
+  if (elf.size() < sizeof(Elf64_Ehdr) ||
+      std::memcmp(elf.data(), ELFMAG, SELFMAG) != 0 ||
+      elf[EI_CLASS] != ELFCLASS64) {
+    ADD_FAILURE() << path << " isn't a 64-bit ELF object";
+    return 0;
+  }
+
+  Elf64_Ehdr header;
+  std::memcpy(&header, elf.data(), sizeof(header));
+  auto section = [&](std::size_t index) {
+    Elf64_Shdr ret;
+    std::memcpy(&ret, elf.data() + header.e_shoff + index * sizeof(ret),
+                sizeof(ret));
+    return ret;
+  };
+  const char* names = elf.data() + section(header.e_shstrndx).sh_offset;
+
+  std::uint64_t size = 0;
+  for (std::size_t i = 0; i < header.e_shnum; ++i) {
+    Elf64_Shdr shdr = section(i);
+    std::string name = names + shdr.sh_name;
+    if (name == ".text" || android::base::StartsWith(name, ".text.")) {
+      size += shdr.sh_size;
+    }
+  }
+  return size;
+}
+
+std::uint64_t TextSizeOf(const char* object) {
+  return TextSize(android::base::GetExecutableDirectory() + "/" + object);
+}
+
+TEST(CodeSizeTest, TableIsSmallest) {
+  std::uint64_t embedded = TextSizeOf("sysprop_size_embedded.o");
+  std::uint64_t runtime = TextSizeOf("sysprop_size_runtime.o");
+  std::uint64_t table = TextSizeOf("sysprop_size_table.o");
+
+  // Sources generated with --runtime leave the parsers and formatters to
+  // libsysprop_runtime, and table-driven ones also leave it the per-enum
+  // parsers and formatters and the per-type template instantiations.
+  EXPECT_GT(table, 0u);
+  EXPECT_LT(table, runtime);
+  EXPECT_LT(runtime, embedded);
+}
+
+}  // namespace